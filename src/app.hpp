@@ -1,8 +1,12 @@
 #pragma once
 
 #include <algorithm>
+#include <cassert>
+#include <memory>
 #include <numbers>
+#include <optional>
 #include <filesystem>
+#include <vector>
 
 #include <SDL2/SDL.h>
 
@@ -10,13 +14,18 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include "arena.hpp"
 #include "color.hpp"
 #include "scene.hpp"
 #include "frustum.hpp"
 #include "canvas.hpp"
 #include "context.hpp"
+#include "frame_sink.hpp"
 #include "mesh.hpp"
+#include "pipeline.hpp"
 #include "polygon.hpp"
+#include "profiler.hpp"
+#include "thread_pool.hpp"
 #include "ui.hpp"
 
 namespace rasterizer {
@@ -26,66 +35,185 @@ namespace rasterizer {
 
     static constexpr std::uint32_t resolutionScale = std::max(RESOLUTION_SCALE, 1);
 
+    // Offscreen rendering, without window, renderer nor UI
+    struct HeadlessOptions {
+        std::uint32_t width = defaultWindowWidth;
+        std::uint32_t height = defaultWindowHeight;
+        // 0 renders until the process is stopped
+        std::uint64_t framesAmount = 0;
+        std::unique_ptr<FrameSink> sink = std::make_unique<DiscardFrameSink>();
+        // Times every stage from the first frame on
+        bool isProfiling = false;
+    };
+
     class Application {
     public:
         bool isRunning = false;
 
-        explicit Application(const std::string_view& title)
-            : context(title),
-              canvas(context.windowWidth / resolutionScale, context.windowHeight / resolutionScale, context),
-              frustum(
-                  static_cast<glm::float32_t>(canvas.width), static_cast<glm::float32_t>(canvas.height),
-                  std::numbers::pi / 3.0f, // 60 degrees
-                  0.1f, 100.0f
-              ) {
-            isRunning = true;
+        // memoryBudgetBytes bounds the resident mesh and surface data, see ResidencyManager
+        explicit Application(const std::string_view& title,
+                             const std::size_t memoryBudgetBytes = ResidencyManager::DEFAULT_BUDGET_BYTES)
+            : Application(std::make_unique<RenderContext>(title), HeadlessOptions{.sink = nullptr}, memoryBudgetBytes) {
+        }
+
+        explicit Application(HeadlessOptions headless,
+                             const std::size_t memoryBudgetBytes = ResidencyManager::DEFAULT_BUDGET_BYTES)
+            : Application(nullptr, std::move(headless), memoryBudgetBytes) {
         }
 
         ~Application() {
             isRunning = false;
         }
 
-        void processInput(const glm::float32_t delta) {
-            SDL_Event event;
-            SDL_PollEvent(&event);
+        bool isHeadless() const {
+            return context == nullptr;
+        }
 
-            // Prioritize UI
-            if (rasterizer::ui::processInput(&event)) {
+        void processInput(const glm::float32_t delta) {
+            if (isHeadless()) {
                 return;
             }
 
-            // Game loop input logic
-            switch (event.type) {
-                case SDL_QUIT:
-                    isRunning = false;
-                    break;
-                case SDL_KEYDOWN:
-                    processKeypress(event.key.keysym.sym, delta);
-                    break;
-                default:
-                    break;
+            // Everything queued since the last frame
+            SDL_Event event;
+            while (SDL_PollEvent(&event)) {
+                if (isInputEvent(event)) {
+                    // Event timestamps only have millisecond resolution
+                    pendingInputs.push_back({
+                        .queuedMilliseconds = SDL_GetTicks() - event.common.timestamp,
+                        .polled = SDL_GetPerformanceCounter()
+                    });
+                }
+
+                // Prioritize UI
+                if (rasterizer::ui::processInput(&event)) {
+                    continue;
+                }
+
+                // Game loop input logic
+                switch (event.type) {
+                    case SDL_QUIT:
+                        isRunning = false;
+                        break;
+                    case SDL_KEYDOWN:
+                        processKeypress(event.key.keysym.sym);
+                        break;
+                    case SDL_RENDER_TARGETS_RESET:
+                    case SDL_RENDER_DEVICE_RESET:
+                        // The texture no longer holds the last frame
+                        drawnState.reset();
+                        break;
+                    default:
+                        break;
+                }
             }
+
+            applyCameraKeys(delta);
         }
 
-        void update(const glm::float32_t delta) {
+        void update([[maybe_unused]] const glm::float32_t delta) {
+            scene.residency.update();
+
             // Orientate frustum according to rotation
             auto cameraRotation = glm::rotate(glm::identity<glm::mat4>(), frustum.yaw, up);
             cameraRotation = glm::rotate(cameraRotation, frustum.pitch, right);
             frustum.forward = glm::mat3(cameraRotation) * forward;
         }
 
-        void render() const {
-            context.newFrame();
-            canvas.clear();
-            canvas.drawGrid();
-            drawScene();
-            rasterizer::ui::render(frustum.eye, frustum.forward, backFaceCulling,
-                                   canvas.isEnabled(PolygonMode::POINT),
-                                   canvas.isEnabled(PolygonMode::LINE),
-                                   canvas.isEnabled(PolygonMode::FILL),
-                                   canvas.fillModeIndex(), canvas.rasterizationRuleIndex());
-            context.render(canvas.texture(), canvas.framebuffer(), canvas.width);
-            context.present();
+        void render() {
+            const auto frameStart = Profiler::Clock::now();
+            // Everything allocated from the arena during the previous frame is released
+            frameArena.reset();
+
+            if (isHeadless()) {
+                headless.sink->prepare(canvas);
+
+                // Frames are complete: requested assets are loaded and the frame drawn again
+                PipelineCounters counters;
+                do {
+                    clearCanvas();
+                    counters = drawScene();
+                    if (!scene.residency.isLoading()) {
+                        break;
+                    }
+                    scene.residency.finishLoading();
+                } while (true);
+
+                headless.sink->consume(canvas, renderedFramesAmount++);
+                profiler.endFrame(Profiler::Clock::now() - frameStart, counters, canvasPixelsAmount());
+                if (headless.framesAmount != 0 && renderedFramesAmount == headless.framesAmount) {
+                    headless.sink->finish();
+                    isRunning = false;
+                }
+                return;
+            }
+
+            context->newFrame();
+            // An unchanged frame is still in the texture, only the UI is drawn again
+            const bool isFrameChanged = updateDrawnState();
+            // Draw straight into the texture when possible
+            const bool isTextureLocked = isFrameChanged && canvas.lockTexture();
+            // An unchanged frame keeps the counters of the frame that drew it
+            PipelineCounters counters = profiler.counters();
+            if (isFrameChanged) {
+                clearCanvas();
+                counters = drawScene();
+            }
+            {
+                const Profiler::Scope scope(profiler, Stage::UI);
+                rasterizer::ui::render(frustum.eye, frustum.forward, backFaceCulling,
+                                       canvas.isEnabled(PolygonMode::POINT),
+                                       canvas.isEnabled(PolygonMode::LINE),
+                                       canvas.isEnabled(PolygonMode::FILL),
+                                       canvas.fillModeIndex(), canvas.rasterizationRuleIndex(),
+                                       pipeline.setupCounters(), inputLatency, profiler);
+            }
+            {
+                const Profiler::Scope scope(profiler, Stage::UPLOAD);
+                if (isTextureLocked) {
+                    canvas.unlockTexture();
+                    context->render(canvas.texture());
+                } else if (!isFrameChanged) {
+                    context->render(canvas.texture());
+                } else {
+                    context->render(canvas.texture(), canvas.framebuffer(), canvas.framebufferStride());
+                }
+            }
+            {
+                // Renders the UI draw lists
+                const Profiler::Scope scope(profiler, Stage::UI);
+                context->present();
+            }
+            profiler.endFrame(Profiler::Clock::now() - frameStart, counters, canvasPixelsAmount());
+
+            // Input applied to this frame is now on screen
+            const std::uint64_t presented = SDL_GetPerformanceCounter();
+            const auto frequency = static_cast<float>(SDL_GetPerformanceFrequency());
+            for (const auto& [queuedMilliseconds, polled] : pendingInputs) {
+                inputLatency.add(static_cast<float>(queuedMilliseconds) +
+                                 1000.0f * static_cast<float>(presented - polled) / frequency);
+            }
+            pendingInputs.clear();
+        }
+
+        const Profiler& frameProfiler() const {
+            return profiler;
+        }
+
+        // Scripted camera, forward follows yaw and pitch on the next update()
+        void moveCamera(const glm::vec3& eye, const glm::float32_t yaw, const glm::float32_t pitch) {
+            frustum.eye = eye;
+            frustum.yaw = yaw;
+            frustum.pitch = pitch;
+        }
+
+        // Filled polygons only, as with keys 3 and 6
+        void setRenderMode(const FillMode fillMode, const RasterizationRule rule) {
+            canvas.enable(PolygonMode::FILL);
+            canvas.disable(PolygonMode::LINE);
+            canvas.disable(PolygonMode::POINT);
+            canvas.set(fillMode);
+            canvas.set(rule);
         }
 
     private:
@@ -95,14 +223,144 @@ namespace rasterizer {
         static constexpr glm::vec3 up{0.0f, 1.0f, 0.0f};
 
         Scene scene;
-        RenderContext context;
+        // Absent when headless
+        const std::unique_ptr<RenderContext> context;
+        HeadlessOptions headless;
+        std::uint64_t renderedFramesAmount = 0;
         Canvas canvas;
         Frustum frustum;
+        mutable Profiler profiler;
+        mutable RasterPipeline pipeline{canvas, profiler, rasterThreadsAmount()};
+        mutable ThreadPool threadPool{geometryThreadsAmount()};
+
+        // Transient per-frame pipeline data
+        static constexpr std::size_t frameArenaCapacity = 8 * 1024 * 1024;
+        mutable FrameArena frameArena{frameArenaCapacity};
+        mutable std::size_t previousMeshletsAmount = 0;
+
+        // Reused across frames, one per scene instance
+        mutable std::vector<glm::mat4> modelViewTransformations;
+        mutable std::vector<glm::mat3> normalTransformations;
+
+        // Triangles of each in flight chunk of meshlets
+        static constexpr std::size_t geometryChunkMeshlets = 16;
+        static constexpr std::size_t geometryChunksInFlight = 16;
+        mutable std::array<std::vector<Triangle>, geometryChunksInFlight> geometryChunks;
+        mutable std::array<PipelineCounters, geometryChunksInFlight> geometryCounters;
 
         bool backFaceCulling = true;
         RasterizationRule currentRule = RasterizationRule::DDA;
 
-        void processKeypress(const SDL_Keycode keycode, const glm::float32_t delta) {
+        // Everything the image depends on, as of the last drawn frame
+        struct DrawnState {
+            glm::vec3 eye, forward;
+            bool backFaceCulling;
+            std::uint32_t canvasModes;
+            std::uint64_t residencyRevision;
+            std::uint64_t sceneRevision;
+        };
+
+        // Empty until the first frame is drawn, and whenever the texture contents are lost
+        std::optional<DrawnState> drawnState;
+
+        // Input events applied since the last present
+        struct PendingInput {
+            // From the event timestamp to the event being polled
+            std::uint32_t queuedMilliseconds;
+            // SDL_GetPerformanceCounter when polled
+            std::uint64_t polled;
+        };
+        std::vector<PendingInput> pendingInputs;
+        RollingSamples inputLatency;
+
+        // Camera keys pressed since the last frame, applied once per frame
+        enum CameraKey : std::uint32_t {
+            PITCH_UP = 1u << 0,
+            PITCH_DOWN = 1u << 1,
+            YAW_LEFT = 1u << 2,
+            YAW_RIGHT = 1u << 3,
+            MOVE_FORWARD = 1u << 4,
+            MOVE_BACKWARD = 1u << 5,
+            MOVE_RIGHT = 1u << 6,
+            MOVE_LEFT = 1u << 7,
+        };
+        std::uint32_t pressedCameraKeys = 0;
+
+        Application(std::unique_ptr<RenderContext> renderContext, HeadlessOptions headlessOptions,
+                    const std::size_t memoryBudgetBytes)
+            : scene(memoryBudgetBytes),
+              context(std::move(renderContext)),
+              headless(std::move(headlessOptions)),
+              canvas(createCanvas(context.get(), headless)),
+              frustum(
+                  static_cast<glm::float32_t>(canvas.width), static_cast<glm::float32_t>(canvas.height),
+                  std::numbers::pi / 3.0f, // 60 degrees
+                  0.1f, 100.0f
+              ) {
+            if (isHeadless() && headless.sink == nullptr) {
+                throw std::runtime_error("Headless rendering requires a frame sink");
+            }
+            profiler.setEnabled(headless.isProfiling);
+            // Unclipped triangles of a chunk
+            for (auto& triangles : geometryChunks) {
+                triangles.reserve(geometryChunkMeshlets * Meshlet::MAX_FACES);
+            }
+            threadPool.reserveOrderedSlots(geometryChunksInFlight);
+            isRunning = true;
+        }
+
+        // Both stages run at once, so they split the spare cores instead of each taking all of them
+        static std::size_t geometryThreadsAmount() {
+            return ThreadPool::defaultThreadsAmount() / 2;
+        }
+
+        // Rasterization is the heavier stage, it gets the odd core
+        static std::uint32_t rasterThreadsAmount() {
+            return static_cast<std::uint32_t>(ThreadPool::defaultThreadsAmount() - geometryThreadsAmount());
+        }
+
+        static Canvas createCanvas(const RenderContext* context, const HeadlessOptions& headless) {
+            if (context == nullptr) {
+                return {headless.width, headless.height};
+            }
+            return {context->windowWidth / resolutionScale, context->windowHeight / resolutionScale, *context};
+        }
+
+        static bool isInputEvent(const SDL_Event& event) {
+            switch (event.type) {
+                case SDL_KEYDOWN:
+                case SDL_KEYUP:
+                case SDL_MOUSEMOTION:
+                case SDL_MOUSEBUTTONDOWN:
+                case SDL_MOUSEBUTTONUP:
+                case SDL_MOUSEWHEEL:
+                    return true;
+                default:
+                    return false;
+            }
+        }
+
+        // Whether the frame has to be drawn again, and if so records what it is drawn from
+        bool updateDrawnState() {
+            DrawnState state{
+                .eye = frustum.eye, .forward = frustum.forward,
+                .backFaceCulling = backFaceCulling,
+                .canvasModes = canvas.modes(),
+                .residencyRevision = scene.residency.revision(),
+                .sceneRevision = scene.revision()
+            };
+            if (drawnState && drawnState->eye == state.eye && drawnState->forward == state.forward
+                && drawnState->backFaceCulling == state.backFaceCulling && drawnState->canvasModes == state.canvasModes
+                && drawnState->residencyRevision == state.residencyRevision
+                && drawnState->sceneRevision == state.sceneRevision) {
+                return false;
+            }
+
+            drawnState = state;
+            return true;
+        }
+
+        void processKeypress(const SDL_Keycode keycode) {
             switch (keycode) {
                 case SDLK_ESCAPE:
                     isRunning = false;
@@ -150,53 +408,94 @@ namespace rasterizer {
                 case SDLK_c:
                     backFaceCulling = !backFaceCulling;
                     break;
+                case SDLK_p:
+                    profiler.setEnabled(!profiler.isEnabled());
+                    break;
                 case SDLK_UP:
-                    frustum.pitch += 1.0f * delta;
+                    pressedCameraKeys |= PITCH_UP;
                     break;
                 case SDLK_DOWN:
-                    frustum.pitch -= 1.0f * delta;
+                    pressedCameraKeys |= PITCH_DOWN;
                     break;
                 case SDLK_LEFT:
-                    frustum.yaw -= 1.0f * delta;
+                    pressedCameraKeys |= YAW_LEFT;
                     break;
                 case SDLK_RIGHT:
-                    frustum.yaw += 1.0f * delta;
+                    pressedCameraKeys |= YAW_RIGHT;
                     break;
-                case SDLK_w: {
-                    frustum.eye += 5.0f * frustum.forward * delta;
+                case SDLK_w:
+                    pressedCameraKeys |= MOVE_FORWARD;
                     break;
-                }
-                case SDLK_s: {
-                    frustum.eye += 5.0f * -frustum.forward * delta;
+                case SDLK_s:
+                    pressedCameraKeys |= MOVE_BACKWARD;
                     break;
-                }
-                case SDLK_d: {
-                    frustum.eye += 5.0f * glm::normalize(glm::cross(up, frustum.forward)) * delta;
+                case SDLK_d:
+                    pressedCameraKeys |= MOVE_RIGHT;
                     break;
-                }
-                case SDLK_a: {
-                    frustum.eye += 5.0f * -glm::normalize(glm::cross(up, frustum.forward)) * delta;
+                case SDLK_a:
+                    pressedCameraKeys |= MOVE_LEFT;
                     break;
-                }
                 default:
                     break;
             }
         }
 
-        void drawScene() const {
-            const auto trianglesToRender = computeTrianglesToRender();
+        void applyCameraKeys(const glm::float32_t delta) {
+            const auto isPressed = [this](const CameraKey key) {
+                return (pressedCameraKeys & key) != 0;
+            };
+            const glm::vec3 sideways = glm::normalize(glm::cross(up, frustum.forward));
 
-            scene.lock();
-            for (const auto& triangle : trianglesToRender) {
-                canvas.drawTriangle(triangle);
+            if (isPressed(PITCH_UP)) {
+                frustum.pitch += 1.0f * delta;
             }
-            scene.unlock();
+            if (isPressed(PITCH_DOWN)) {
+                frustum.pitch -= 1.0f * delta;
+            }
+            if (isPressed(YAW_LEFT)) {
+                frustum.yaw -= 1.0f * delta;
+            }
+            if (isPressed(YAW_RIGHT)) {
+                frustum.yaw += 1.0f * delta;
+            }
+            if (isPressed(MOVE_FORWARD)) {
+                frustum.eye += 5.0f * frustum.forward * delta;
+            }
+            if (isPressed(MOVE_BACKWARD)) {
+                frustum.eye += 5.0f * -frustum.forward * delta;
+            }
+            if (isPressed(MOVE_RIGHT)) {
+                frustum.eye += 5.0f * sideways * delta;
+            }
+            if (isPressed(MOVE_LEFT)) {
+                frustum.eye += 5.0f * -sideways * delta;
+            }
+            pressedCameraKeys = 0;
+        }
+
+        // Meshlet that survived cluster culling
+        struct VisibleMeshlet {
+            const Mesh* mesh;
+            std::size_t lodIndex;
+            const Meshlet* meshlet;
+            const Surface* surface;
+            std::size_t instance;
+        };
+
+        std::uint64_t canvasPixelsAmount() const {
+            return static_cast<std::uint64_t>(canvas.width) * canvas.height;
         }
 
-        std::vector<Triangle> computeTrianglesToRender() const {
-            std::vector<Triangle> trianglesToRender;
-            trianglesToRender.reserve(scene.meshes.size());
+        void clearCanvas() {
+            const Profiler::Scope scope(profiler, Stage::CLEAR);
+            canvas.clear();
+            canvas.drawGrid();
+        }
 
+        PipelineCounters drawScene() const {
+#ifndef NDEBUG
+            const std::size_t heapAllocationsBefore = heapAllocationsAmount.load();
+#endif
             const auto projection = frustum.perspectiveProjection();
             const auto viewport = glm::mat4{
                 canvas.width / 2.0f, 0.0f, 0.0f, 0.0f,
@@ -207,69 +506,250 @@ namespace rasterizer {
 
             // Offset the camera position in the direction where the camera is pointing at
             const auto view = frustum.view(frustum.eye + frustum.forward, up);
-            for (std::size_t m = 0; m < scene.meshes.size(); ++m) {
-                const auto& mesh = scene.meshes[m];
-                for (std::size_t face = 0; face < mesh.facesAmount(); ++face) {
-                    // Extract vertices
-                    const auto meshModel = mesh.modelTransformation();
-                    auto [v0, v1, v2] = std::apply(
-                        [](const auto&... vertices) {
-                            return std::make_tuple(glm::vec4{vertices, 1.0f}...);
-                        },
-                        mesh[face].vertices
-                    );
+            if (const std::size_t instancesAmount = scene.instances().size();
+                modelViewTransformations.capacity() < instancesAmount) {
+                // More instances than any previous frame
+                const UncountedAllocations growth;
+                modelViewTransformations.reserve(instancesAmount);
+                normalTransformations.reserve(instancesAmount);
+            }
+            {
+                const Profiler::Scope scope(profiler, Stage::TRANSFORM);
+                rasterizer::computeModelViewTransformations(scene.instances(), view, modelViewTransformations);
+                rasterizer::computeNormalTransformations(modelViewTransformations, normalTransformations);
+            }
 
-                    // Transform to View-space
-                    v0 = toViewSpace(v0, meshModel, view); /*    v0     */
-                    v1 = toViewSpace(v1, meshModel, view); /*  /    \   */
-                    v2 = toViewSpace(v2, meshModel, view); /* v2 --- v1 */
+            const auto visibleMeshlets = [&] {
+                const Profiler::Scope scope(profiler, Stage::CULL);
+                return computeVisibleMeshlets();
+            }();
 
-                    // Cull if necessary
-                    const auto normal = computeNormal(v0, v1, v2);
+            const std::size_t chunksAmount = (visibleMeshlets.size() + geometryChunkMeshlets - 1) /
+                                             geometryChunkMeshlets;
 
+            // Chunks are processed in parallel and submitted in order
+            PipelineCounters counters;
+            scene.lock();
+            threadPool.parallelOrdered(
+                chunksAmount, geometryChunksInFlight,
+                [&](const std::size_t chunk, const std::size_t slot) {
+                    auto& triangles = geometryChunks[slot];
+                    triangles.clear();
+                    geometryCounters[slot] = {};
+
+                    const std::size_t end = std::min((chunk + 1) * geometryChunkMeshlets, visibleMeshlets.size());
+                    for (std::size_t m = chunk * geometryChunkMeshlets; m < end; ++m) {
+                        appendMeshletTriangles(visibleMeshlets[m], projection, viewport, triangles,
+                                               geometryCounters[slot]);
+                    }
+                },
+                [&](const std::size_t, const std::size_t slot) {
+                    counters += geometryCounters[slot];
+                    pipeline.submit(geometryChunks[slot]);
+                });
+            pipeline.finish();
+            scene.unlock();
+
+            counters.fragments = pipeline.fragmentCounters();
+
+#ifndef NDEBUG
+            // On every thread, except for the growth of buffers that are kept for the next frames
+            assert(heapAllocationsAmount.load() == heapAllocationsBefore);
+#endif
+            return counters;
+        }
+
+        FrameVector<VisibleMeshlet> computeVisibleMeshlets() const {
+            // Sized after the previous frame, growing would leave holes in the arena
+            FrameVector<VisibleMeshlet> visibleMeshlets{ArenaAllocator<VisibleMeshlet>(frameArena)};
+            visibleMeshlets.reserve(previousMeshletsAmount + previousMeshletsAmount / 4);
+
+            const auto& instances = scene.instances();
+            for (std::size_t i = 0; i < instances.size(); ++i) {
+                const auto& instance = instances[i];
+                const auto& modelView = modelViewTransformations[i];
+                const auto& normalTransformation = normalTransformations[i];
+
+                // Cone culling relies on angles being preserved by the Model transformation
+                const auto& scale = instance.scale;
+                const bool isScaleUniform = scale.x == scale.y && scale.y == scale.z;
+                const glm::float32_t maxScale = std::max({std::abs(scale.x), std::abs(scale.y), std::abs(scale.z)});
+
+                // Assets are requested while visible, bounds may be unknown until loaded
+                if (const auto& bounds = scene.residency.bounds(instance.mesh);
+                    bounds && frustum.isSphereOutside(modelView * glm::vec4{bounds->center, 1.0f},
+                                                      bounds->radius * maxScale)) {
+                    continue;
+                }
+
+                const Mesh* residentMesh = scene.residency.requestMesh(instance.mesh);
+                if (residentMesh == nullptr) {
+                    // Streaming in
+                    continue;
+                }
+                const auto& mesh = *residentMesh;
+                const Surface* surface = scene.residency.requestSurface(instance.surface);
+
+                // Screen-space size of one Model-space unit at the closest point of the mesh
+                const glm::vec3 meshCenter = modelView * glm::vec4{mesh.center, 1.0f};
+                const glm::float32_t distance = std::max(glm::length(meshCenter) - mesh.radius * maxScale,
+                                                         frustum.near);
+                const glm::float32_t pixelsPerUnit = maxScale * static_cast<glm::float32_t>(canvas.height) /
+                                                     (2.0f * std::tan(frustum.fovVertical / 2.0f) * distance);
+                const std::size_t lodIndex = mesh.selectLod(pixelsPerUnit);
+                const auto& lod = mesh.lods[lodIndex];
+
+                for (const auto& meshlet : lod.meshlets.meshlets) {
+                    // Reject the whole cluster before transforming any of its vertices
+                    const glm::vec3 center = modelView * glm::vec4{meshlet.center, 1.0f};
+                    const glm::float32_t radius = meshlet.radius * maxScale;
+
+                    if (frustum.isSphereOutside(center, radius)) {
+                        continue;
+                    }
+
+                    if (backFaceCulling && isScaleUniform) {
+                        // Transformed as the face normals, so that a negative scale does not flip it
+                        const auto coneAxis = glm::normalize(normalTransformation * meshlet.coneAxis);
+
+                        // Camera position in View-space is always [0 0 0] => center - [0 0 0] = center
+                        // Cull if every face normal points away from every point of the bounding sphere
+                        if (glm::dot(center, coneAxis) >= meshlet.coneCutoff * glm::length(center) + radius) {
+                            continue;
+                        }
+                    }
+
+                    visibleMeshlets.emplace_back(VisibleMeshlet{
+                        .mesh = &mesh,
+                        .lodIndex = lodIndex,
+                        .meshlet = &meshlet,
+                        .surface = surface,
+                        .instance = i
+                    });
+                }
+            }
+
+            previousMeshletsAmount = visibleMeshlets.size();
+
+            return visibleMeshlets;
+        }
+
+        void appendMeshletTriangles(const VisibleMeshlet& visibleMeshlet,
+                                    const glm::mat4& projection,
+                                    const glm::mat4& viewport,
+                                    std::vector<Triangle>& triangles,
+                                    PipelineCounters& counters) const {
+            const auto& [mesh, lodIndex, meshlet, surface, instance] = visibleMeshlet;
+            const auto& lod = mesh->lods[lodIndex];
+            const auto& modelView = modelViewTransformations[instance];
+            const auto& normalTransformation = normalTransformations[instance];
+
+            // Transform to View-space once per meshlet vertex
+            std::array<glm::vec4, Meshlet::MAX_VERTICES> viewVertices;
+            std::array<glm::vec2, Meshlet::MAX_VERTICES> uvs;
+            // Face normals in View-space, in one batch per meshlet
+            std::array<glm::vec3, Meshlet::MAX_FACES> viewNormals;
+            {
+                const Profiler::Scope scope(profiler, Stage::TRANSFORM);
+                if (mesh->vertexFormat == VertexFormat::QUANTIZED16) {
+                    // Positions are dequantized by the transformation itself
+                    const glm::mat4 dequantizedModelView = modelView * mesh->quantization.positionTransformation();
+                    for (std::uint32_t v = 0; v < meshlet->verticesAmount; ++v) {
+                        const auto& vertex =
+                            mesh->quantizedVertices[lod.meshlets.vertices[meshlet->vertexOffset + v]];
+                        const auto& position = vertex.position;
+                        viewVertices[v] = toViewSpace(glm::vec4(position[0], position[1], position[2], 1.0f),
+                                                      dequantizedModelView);
+                        uvs[v] = mesh->quantization.dequantizeUv(vertex);
+                    }
+                } else {
+                    for (std::uint32_t v = 0; v < meshlet->verticesAmount; ++v) {
+                        const auto& vertex = mesh->vertices[lod.meshlets.vertices[meshlet->vertexOffset + v]];
+                        viewVertices[v] = toViewSpace(glm::vec4{vertex.position, 1.0f}, modelView);
+                        uvs[v] = vertex.uv;
+                    }
+                }
+
+                for (std::uint32_t f = 0; f < meshlet->facesAmount; ++f) {
+                    const auto normal = normalTransformation * lod.faceNormals[meshlet->faceOffset + f];
+                    const glm::float32_t length = glm::length(normal);
+                    viewNormals[f] = length > 0.0f ? normal / length : glm::vec3{0.0f};
+                }
+            }
+            counters.trianglesIn += meshlet->facesAmount;
+
+            // Faces of the meshlet, relative to faceOffset, that face the camera
+            std::array<std::uint8_t, Meshlet::MAX_FACES> frontFaces;
+            std::size_t frontFacesAmount = 0;
+            {
+                const Profiler::Scope scope(profiler, Stage::CULL);
+                for (std::uint32_t f = 0; f < meshlet->facesAmount; ++f) {
                     if (backFaceCulling) {
                         // Points are in View-space, camera position in View-space is always [0 0 0]
                         // [0 0 0] - v = -v
-                        const auto triangleToCamera = glm::normalize(-glm::vec3(v0));
+                        const std::uint8_t v0 = lod.meshlets.triangles[3 * (meshlet->faceOffset + f)];
+                        const auto triangleToCamera = -glm::vec3(viewVertices[v0]);
 
                         // Cull if triangle normal and triangleToCamera are not pointing in the same direction
-                        if (glm::dot(normal, triangleToCamera) < 0.0f) {
+                        // Only the sign matters, triangleToCamera does not need to be normalized
+                        if (glm::dot(viewNormals[f], triangleToCamera) < 0.0f) {
                             continue;
                         }
                     }
+                    frontFaces[frontFacesAmount++] = static_cast<std::uint8_t>(f);
+                }
+            }
+            counters.trianglesCulled += meshlet->facesAmount - frontFacesAmount;
+
+            const Profiler::Scope scope(profiler, Stage::CLIP);
+            for (std::size_t f = 0; f < frontFacesAmount; ++f) {
+                const std::size_t face = meshlet->faceOffset + frontFaces[f];
+
+                // Extract vertices
+                const std::uint8_t* corners = &lod.meshlets.triangles[3 * face];
+                const auto& v0 = viewVertices[corners[0]]; /*    v0     */
+                const auto& v1 = viewVertices[corners[1]]; /*  /    \   */
+                const auto& v2 = viewVertices[corners[2]]; /* v2 --- v1 */
+
+                // Every clipped triangle of the face shares the same lighting
+                const color_t surfaceColor = scene.light.modulateSurfaceColor(lod.faceColors[face],
+                                                                              viewNormals[frontFaces[f]]);
+
+                // Clip and add clipped triangles to result
+                const auto clippedPolygon = frustum.clipPolygon(
+                    Polygon::fromTriangle({v0, v1, v2}, {uvs[corners[0]], uvs[corners[1]], uvs[corners[2]]}));
+                if (clippedPolygon.trianglesAmount() == 0) {
+                    counters.trianglesClipped++;
+                }
+                counters.trianglesEmitted += clippedPolygon.trianglesAmount();
 
-                    // Clip and add clipped triangles to result
-                    const auto clippedPolygon = frustum.clipPolygon(
-                        Polygon::fromTriangle({v0, v1, v2}, mesh[face].uvs));
-
-                    for (std::size_t t = 0; t < clippedPolygon.trianglesAmount(); ++t) {
-                        const auto [pv0, pv1, pv2, puv0, puv1, puv2] = clippedPolygon[t];
-
-                        const color_t surfaceColor = scene.light.modulateSurfaceColor(
-                            rasterizer::randomColor(face), normal);
-                        trianglesToRender.emplace_back(Triangle{
-                            .vertices = {
-                                // These are points, not vectors => w = 1.0f
-                                toScreenSpace(glm::vec4{pv0, 1.0f}, projection, viewport),
-                                toScreenSpace(glm::vec4{pv1, 1.0f}, projection, viewport),
-                                toScreenSpace(glm::vec4{pv2, 1.0f}, projection, viewport)
-                            },
-                            .uvs = {puv0, puv1, puv2},
-                            .colors = {surfaceColor, surfaceColor, surfaceColor},
-                            .surface = scene.meshSurfaces[m].get()
-                        });
+                for (std::size_t t = 0; t < clippedPolygon.trianglesAmount(); ++t) {
+                    const auto [pv0, pv1, pv2, puv0, puv1, puv2] = clippedPolygon[t];
+
+                    if (triangles.size() == triangles.capacity()) {
+                        // Clipping produced more triangles than the chunk ever held, kept for the next frames
+                        const UncountedAllocations growth;
+                        triangles.reserve(2 * triangles.capacity());
                     }
+
+                    triangles.emplace_back(Triangle{
+                        .vertices = {
+                            // These are points, not vectors => w = 1.0f
+                            toScreenSpace(glm::vec4{pv0, 1.0f}, projection, viewport),
+                            toScreenSpace(glm::vec4{pv1, 1.0f}, projection, viewport),
+                            toScreenSpace(glm::vec4{pv2, 1.0f}, projection, viewport)
+                        },
+                        .uvs = {puv0, puv1, puv2},
+                        .colors = {surfaceColor, surfaceColor, surfaceColor},
+                        .surface = surface
+                    });
                 }
             }
-
-            return trianglesToRender;
         }
 
-        static glm::vec4 toViewSpace(const glm::vec4& pointModelSpace,
-                                     const glm::mat4& model,
-                                     const glm::mat4& view) {
+        static glm::vec4 toViewSpace(const glm::vec4& pointModelSpace, const glm::mat4& modelView) {
             // Model-space -> World-space -> View-space
-            return view * model * pointModelSpace;
+            return modelView * pointModelSpace;
         }
 
         static glm::vec4 toScreenSpace(const glm::vec4& pointViewSpace,
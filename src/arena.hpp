@@ -0,0 +1,166 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <stdexcept>
+#include <vector>
+
+namespace rasterizer {
+    /*
+     * Linear allocator for data that only lives for a single frame.
+     * Allocations bump an offset into one contiguous block and are all released at once by reset().
+     * Running out of space falls back to individual heap blocks, which are coalesced into a larger
+     * primary block on the next reset(). Once the arena has seen the largest frame, it no longer grows.
+     */
+    class FrameArena {
+    public:
+        explicit FrameArena(const std::size_t capacity) : capacity(capacity) {
+            block = static_cast<std::byte*>(std::malloc(capacity));
+            if (block == nullptr) {
+                throw std::runtime_error("Failed to allocate FrameArena.block");
+            }
+        }
+
+        ~FrameArena() {
+            releaseOverflow();
+            std::free(block);
+            block = nullptr;
+        }
+
+        FrameArena(const FrameArena&) = delete;
+        FrameArena& operator=(const FrameArena&) = delete;
+
+        void* allocate(const std::size_t bytes, const std::size_t alignment) {
+            const std::size_t alignedOffset = (offset + alignment - 1) & ~(alignment - 1);
+            if (alignedOffset + bytes <= capacity) {
+                offset = alignedOffset + bytes;
+                return block + alignedOffset;
+            }
+
+            return allocateOverflow(bytes, alignment);
+        }
+
+        // Invalidates every allocation made since the previous reset
+        void reset() {
+            const std::size_t frameBytes = usedBytes();
+
+            // Debug counter: a frame that fits within an already seen peak must not overflow
+            assert(frameHeapAllocations == 0 || frameBytes > peakBytes);
+            peakBytes = std::max(peakBytes, frameBytes);
+
+            if (overflow != nullptr) {
+                // Grow so that the peak fits in the primary block, with headroom for slowly growing frames
+                releaseOverflow();
+                std::free(block);
+                capacity = peakBytes + peakBytes / 2;
+                block = static_cast<std::byte*>(std::malloc(capacity));
+                if (block == nullptr) {
+                    throw std::runtime_error("Failed to grow FrameArena.block");
+                }
+            }
+
+            offset = 0;
+            frameHeapAllocations = 0;
+        }
+
+        std::size_t usedBytes() const {
+            return offset + overflowBytes;
+        }
+
+    private:
+        struct OverflowBlock {
+            OverflowBlock* next;
+        };
+
+        std::byte* block = nullptr;
+        std::size_t capacity = 0;
+        std::size_t offset = 0;
+
+        OverflowBlock* overflow = nullptr;
+        std::size_t overflowBytes = 0;
+
+        std::size_t peakBytes = 0;
+        std::size_t frameHeapAllocations = 0;
+
+        void* allocateOverflow(const std::size_t bytes, const std::size_t alignment) {
+            // Header followed by enough space to align the payload
+            auto* raw = static_cast<std::byte*>(std::malloc(sizeof(OverflowBlock) + alignment + bytes));
+            if (raw == nullptr) {
+                throw std::bad_alloc();
+            }
+            frameHeapAllocations++;
+            overflowBytes += bytes;
+
+            auto* overflowBlock = reinterpret_cast<OverflowBlock*>(raw);
+            overflowBlock->next = overflow;
+            overflow = overflowBlock;
+
+            const auto payload = reinterpret_cast<std::uintptr_t>(raw + sizeof(OverflowBlock));
+            return reinterpret_cast<void*>((payload + alignment - 1) & ~(alignment - 1));
+        }
+
+        void releaseOverflow() {
+            while (overflow != nullptr) {
+                OverflowBlock* next = overflow->next;
+                std::free(overflow);
+                overflow = next;
+            }
+            overflowBytes = 0;
+        }
+    };
+
+    // Standard allocator adaptor so that containers can live in a FrameArena
+    template<typename T>
+    struct ArenaAllocator {
+        using value_type = T;
+
+        FrameArena* arena;
+
+        explicit ArenaAllocator(FrameArena& arena) : arena(&arena) {
+        }
+
+        template<typename U>
+        ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {
+        }
+
+        T* allocate(const std::size_t n) {
+            return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T)));
+        }
+
+        void deallocate(T*, std::size_t) {
+            // Memory is reclaimed all at once by FrameArena::reset
+        }
+
+        template<typename U>
+        bool operator==(const ArenaAllocator<U>& other) const {
+            return arena == other.arena;
+        }
+    };
+
+    template<typename T>
+    using FrameVector = std::vector<T, ArenaAllocator<T>>;
+
+    // Calls to the global operator new from every thread, only counted by debug builds of the rasterizer
+    inline std::atomic<std::size_t> heapAllocationsAmount{0};
+    // Nonzero on threads that do not draw (asset loading, frame writing) and within UncountedAllocations
+    inline thread_local std::size_t uncountedAllocationsDepth = 0;
+
+    // Allocations a frame is expected to make, such as starting to load an asset
+    struct UncountedAllocations {
+        UncountedAllocations() {
+            ++uncountedAllocationsDepth;
+        }
+
+        ~UncountedAllocations() {
+            --uncountedAllocationsDepth;
+        }
+
+        UncountedAllocations(const UncountedAllocations&) = delete;
+        UncountedAllocations& operator=(const UncountedAllocations&) = delete;
+    };
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <span>
+#include <system_error>
+
+#include "mapped_file.hpp"
+
+namespace rasterizer {
+    // Sections of asset files start on a cache line
+    static constexpr std::size_t ASSET_SECTION_ALIGNMENT = 64;
+
+    inline std::size_t alignAssetSection(const std::size_t offset) {
+        return (offset + ASSET_SECTION_ALIGNMENT - 1) / ASSET_SECTION_ALIGNMENT * ASSET_SECTION_ALIGNMENT;
+    }
+
+    // Identifies the file an asset file was built from
+    struct AssetSource {
+        std::uint64_t bytesAmount;
+        // Last write time, in filesystem clock ticks
+        std::int64_t modified;
+        std::uint64_t hash;
+    };
+
+    // Non-cryptographic 64-bit hash, 8 bytes per step
+    inline std::uint64_t hashBytes(const std::span<const std::byte> bytes) {
+        static constexpr std::uint64_t MULTIPLIER = 0x9e3779b97f4a7c15ull;
+
+        const auto mix = [](std::uint64_t hash, const std::uint64_t word) {
+            hash = (hash ^ word) * MULTIPLIER;
+            return hash ^ (hash >> 29);
+        };
+
+        std::uint64_t hash = bytes.size();
+        std::size_t i = 0;
+        for (; i + sizeof(std::uint64_t) <= bytes.size(); i += sizeof(std::uint64_t)) {
+            std::uint64_t word;
+            std::memcpy(&word, bytes.data() + i, sizeof(word));
+            hash = mix(hash, word);
+        }
+        std::uint64_t tail = 0;
+        if (i < bytes.size()) {
+            std::memcpy(&tail, bytes.data() + i, bytes.size() - i);
+        }
+
+        return mix(hash, tail);
+    }
+
+    // Size and modification time of path, without reading it (hash is left at 0)
+    inline std::optional<AssetSource> statSource(const std::filesystem::path& path) {
+        std::error_code error;
+        const auto bytesAmount = std::filesystem::file_size(path, error);
+        if (error) {
+            return std::nullopt;
+        }
+        const auto modified = std::filesystem::last_write_time(path, error);
+        if (error) {
+            return std::nullopt;
+        }
+
+        return AssetSource{
+            .bytesAmount = bytesAmount,
+            .modified = static_cast<std::int64_t>(modified.time_since_epoch().count()),
+            .hash = 0
+        };
+    }
+
+    inline AssetSource describeSource(const std::filesystem::path& path, const std::span<const std::byte> contents) {
+        auto source = statSource(path).value_or(AssetSource{.bytesAmount = contents.size(), .modified = 0, .hash = 0});
+        source.hash = hashBytes(contents);
+        return source;
+    }
+
+    /*
+     * Whether an asset file built from source is still up to date: the source has the same size and either
+     * the same modification time or, when only the time changed (e.g. after a checkout), the same content hash.
+     * An asset file without its source is used as is.
+     */
+    inline bool isSourceUnchanged(const AssetSource& source, const std::filesystem::path& sourcePath) {
+        const auto current = statSource(sourcePath);
+        if (!current) {
+            return true;
+        }
+        if (current->bytesAmount != source.bytesAmount) {
+            return false;
+        }
+        if (current->modified == source.modified) {
+            return true;
+        }
+
+        const MappedFile file(sourcePath);
+        return hashBytes({file.data(), file.bytesAmount()}) == source.hash;
+    }
+
+    // Best effort, the file is written aside and renamed so that readers never see a partial file
+    inline bool writeAssetFile(const std::filesystem::path& path, const std::span<const std::byte> image) {
+        auto temporaryPath = path;
+        temporaryPath += ".tmp";
+
+        {
+            std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char*>(image.data()), static_cast<std::streamsize>(image.size()));
+            if (!file.good()) {
+                file.close();
+                std::error_code error;
+                std::filesystem::remove(temporaryPath, error);
+                return false;
+            }
+        }
+
+        std::error_code error;
+        std::filesystem::rename(temporaryPath, path, error);
+        if (error) {
+            std::filesystem::remove(temporaryPath, error);
+            return false;
+        }
+
+        return true;
+    }
+}
@@ -1,8 +1,8 @@
 #pragma once
 
 #include <cstdint>
-#include <functional>
 #include <iostream>
+#include <utility>
 
 #include <SDL2/SDL_render.h>
 #include <glm/glm.hpp>
@@ -10,6 +10,7 @@
 #include "color.hpp"
 #include "context.hpp"
 #include "polygon.hpp"
+#include "stats.hpp"
 
 namespace rasterizer {
     enum class PolygonMode : std::uint32_t {
@@ -28,24 +29,33 @@ namespace rasterizer {
         TOP_LEFT = 1 << 1,
     };
 
-    typedef std::function<color_t(const glm::vec3&, const glm::float32_t&)> ColorShader;
+    // Path a triangle takes through triangle setup
+    enum class TriangleSetup : std::uint8_t {
+        // Nothing to fill
+        ZERO_AREA,
+        NO_SAMPLE,
+        // Bounding box covers at most 2x2 pixel samples
+        MICRO,
+        REGULAR,
+    };
+
+    // Half-open range of canvas rows a draw call is allowed to write to
+    struct RowRange {
+        std::int32_t begin, end;
+    };
 
     class Canvas {
     public:
         const std::uint32_t width, height;
 
-        Canvas(const std::uint32_t width, const std::uint32_t height,
-               const RenderContext& context) : width(width), height(height) {
-            SDL_Texture* rawFramebufferTexture = createFramebufferTexture(context.renderer.get(), width, height);
-            if (rawFramebufferTexture == nullptr) {
-                throw std::runtime_error("Failed to initialize Canvas.frambufferTexture");
-            }
-            framebufferTexture.reset(rawFramebufferTexture);
-
+        // Headless, renders into its own buffers only
+        Canvas(const std::uint32_t width, const std::uint32_t height) : width(width), height(height) {
             colorBuffer = createColorBuffer(width, height);
             if (colorBuffer == nullptr) {
                 throw std::runtime_error("Failed to create Canvas.colorBuffer");
             }
+            colorTarget = colorBuffer;
+            colorTargetStride = width;
 
             depthBuffer = createDepthBuffer(width, height);
             if (depthBuffer == nullptr) {
@@ -53,6 +63,15 @@ namespace rasterizer {
             }
         }
 
+        Canvas(const std::uint32_t width, const std::uint32_t height,
+               const RenderContext& context) : Canvas(width, height) {
+            SDL_Texture* rawFramebufferTexture = createFramebufferTexture(context.renderer.get(), width, height);
+            if (rawFramebufferTexture == nullptr) {
+                throw std::runtime_error("Failed to initialize Canvas.frambufferTexture");
+            }
+            framebufferTexture.reset(rawFramebufferTexture);
+        }
+
         ~Canvas() {
             if (depthBuffer != nullptr) {
                 std::free(depthBuffer);
@@ -65,41 +84,113 @@ namespace rasterizer {
         }
 
         const color_t* framebuffer() const {
-            return colorBuffer;
+            return colorTarget;
+        }
+
+        // Pixels from one row of framebuffer to the next
+        std::uint32_t framebufferStride() const {
+            return colorTargetStride;
+        }
+
+        /*
+         * Continues drawing into buffer and hands over the finished frame, so that it can be kept past the frame.
+         * Ownership moves both ways, buffers are width * height pixels from createColorBuffer.
+         */
+        [[nodiscard]] color_t* exchangeColorBuffer(color_t* buffer) {
+            if (colorTarget == colorBuffer) {
+                colorTarget = buffer;
+            }
+            return std::exchange(colorBuffer, buffer);
+        }
+
+        // Draws into height rows of stride pixels owned by someone else, until detached
+        void attachColorTarget(color_t* target, const std::uint32_t stride) {
+            colorTarget = target;
+            colorTargetStride = stride;
         }
 
+        void attachColorTarget(color_t* target) {
+            attachColorTarget(target, width);
+        }
+
+        void detachColorTarget() {
+            colorTarget = colorBuffer;
+            colorTargetStride = width;
+        }
+
+        /*
+         * Draws straight into the pixel memory of the streaming texture until unlockTexture, instead of drawing
+         * into colorBuffer and copying it into the texture afterwards. The locked memory is write-only and
+         * starts undefined, clear() overwrites all of it. False when the texture cannot be drawn into directly.
+         */
+        bool lockTexture() {
+            void* pixels;
+            std::int32_t pitch;
+            if (framebufferTexture == nullptr
+                || SDL_LockTexture(framebufferTexture.get(), nullptr, &pixels, &pitch) != EXIT_SUCCESS) {
+                return false;
+            }
+            if (pitch % sizeof(color_t) != 0) {
+                SDL_UnlockTexture(framebufferTexture.get());
+                return false;
+            }
+
+            attachColorTarget(static_cast<color_t*>(pixels), pitch / sizeof(color_t));
+            return true;
+        }
+
+        // Uploads what was drawn since lockTexture
+        void unlockTexture() {
+            detachColorTarget();
+            SDL_UnlockTexture(framebufferTexture.get());
+        }
+
+        static color_t* createColorBuffer(const std::uint32_t width, const std::uint32_t height) {
+            return static_cast<color_t*>(std::calloc(width * height, sizeof(color_t)));
+        }
+
+        // nullptr when headless
         SDL_Texture* texture() const {
             return framebufferTexture.get();
         }
 
         void drawPixel(const std::int32_t row, const std::int32_t column, const color_t color) const {
-            if (0 <= row && row < height && 0 <= column && column < width) {
-                colorBuffer[row * width + column] = color;
+            if (0 <= row && row < static_cast<std::int32_t>(height) &&
+                0 <= column && column < static_cast<std::int32_t>(width)) {
+                colorTarget[row * colorTargetStride + column] = color;
             }
         }
 
         void drawRectangle(const std::int32_t x, const std::int32_t y,
                            const std::uint32_t width, const std::uint32_t height,
                            const color_t color) const {
+            drawRectangle(x, y, width, height, color, allRows());
+        }
+
+        void drawRectangle(const std::int32_t x, const std::int32_t y,
+                           const std::uint32_t width, const std::uint32_t height,
+                           const color_t color, const RowRange& rows) const {
             const std::uint32_t endX = std::min(x + width, this->width);
-            const std::uint32_t endY = std::min(y + height, this->height);
+            const std::uint32_t endY = std::min(std::min(y + height, this->height),
+                                                static_cast<std::uint32_t>(std::max(rows.end, 0)));
 
-            for (std::uint32_t row = std::max(y, 0); row < endY; ++row) {
+            for (std::uint32_t row = std::max({y, rows.begin, 0}); row < endY; ++row) {
                 for (std::uint32_t column = std::max(x, 0); column < endX; ++column) {
                     drawPixel(row, column, color);
                 }
             }
         }
 
-        void drawPoint(const glm::ivec2& point, const color_t color) const {
+        void drawPoint(const glm::ivec2& point, const color_t color, const RowRange& rows) const {
             static constexpr std::uint32_t pointWidth = 10, pointHeight = 10;
             // Draw centered, with side length 10
             drawRectangle(point.x - static_cast<std::int32_t>(pointWidth / 2),
                           point.y - static_cast<std::int32_t>(pointHeight / 2),
-                          pointWidth, pointHeight, color);
+                          pointWidth, pointHeight, color, rows);
         }
 
-        void drawLine(const glm::ivec2& start, const glm::ivec2& end, const color_t color) const {
+        void drawLine(const glm::ivec2& start, const glm::ivec2& end, const color_t color,
+                      const RowRange& rows) const {
             // DDA line rasterizer
             const std::int32_t dx = end.x - start.x;
             const std::int32_t dy = end.y - start.y;
@@ -113,14 +204,70 @@ namespace rasterizer {
             glm::float32_t x = start.x;
             glm::float32_t y = start.y;
             for (std::uint32_t l = 0; l <= longestLength; l++) {
-                drawPixel(static_cast<std::int32_t>(std::round(y)), static_cast<std::int32_t>(std::round(x)),
-                          color);
+                if (const auto row = static_cast<std::int32_t>(std::round(y)); rows.begin <= row && row < rows.end) {
+                    drawPixel(row, static_cast<std::int32_t>(std::round(x)), color);
+                }
                 x += xIncrement;
                 y += yIncrement;
             }
         }
 
         void drawTriangle(const Triangle& triangle) const {
+            FragmentCounters fragments;
+            drawTriangle(triangle, allRows(), classify(triangle), fragments);
+        }
+
+        /*
+         * Cheap test run before any setup work, using the same sampling as the current rasterization rule.
+         * DDA works on the truncated integer vertices, top-left samples pixel centers and, like its
+         * inside test, discards the opposite winding.
+         */
+        TriangleSetup classify(const Triangle& triangle) const {
+            const auto& [v0, v1, v2] = triangle.vertices;
+
+            if (rasterizationRuleMask & static_cast<std::uint32_t>(RasterizationRule::DDA)) {
+                const glm::ivec2 p0{v0}, p1{v1}, p2{v2};
+                const auto p01 = p1 - p0, p02 = p2 - p0;
+                if (p01.x * p02.y - p01.y * p02.x == 0) {
+                    return TriangleSetup::ZERO_AREA;
+                }
+
+                // Every pixel DDA writes is within the integer bounding box
+                const auto min = glm::min(glm::min(p0, p1), p2);
+                const auto max = glm::max(glm::max(p0, p1), p2);
+                if (max.x < 0 || max.y < 0 || min.x >= static_cast<std::int32_t>(width) ||
+                    min.y >= static_cast<std::int32_t>(height)) {
+                    return TriangleSetup::NO_SAMPLE;
+                }
+
+                return TriangleSetup::REGULAR;
+            }
+
+            const glm::float32_t area = edgeCross(v0, v1, v2);
+            if (area == 0.0f) {
+                return TriangleSetup::ZERO_AREA;
+            }
+            if (area < 0.0f) {
+                return TriangleSetup::NO_SAMPLE;
+            }
+
+            const auto [first, last] = sampleBounds(v0, v1, v2);
+            if (first.x > last.x || first.y > last.y) {
+                return TriangleSetup::NO_SAMPLE;
+            }
+
+            return last.x - first.x < 2 && last.y - first.y < 2 ? TriangleSetup::MICRO : TriangleSetup::REGULAR;
+        }
+
+        // Whether a triangle of the given class writes anything with the current polygon modes
+        bool needsRasterization(const TriangleSetup setup) const {
+            return setup == TriangleSetup::MICRO || setup == TriangleSetup::REGULAR ||
+                   polygonModeMask & (static_cast<std::uint32_t>(PolygonMode::LINE) |
+                                      static_cast<std::uint32_t>(PolygonMode::POINT));
+        }
+
+        void drawTriangle(const Triangle& triangle, const RowRange& rows, const TriangleSetup setup,
+                          FragmentCounters& fragments) const {
             // Convention: 3 or 4 dimension vertices -> vN, 2 dimension points pN
             auto [v0, v1, v2] = triangle.vertices;
             auto [p0, p1, p2] = std::make_tuple(glm::ivec2{v0}, glm::ivec2{v1}, glm::ivec2{v2});
@@ -139,26 +286,37 @@ namespace rasterizer {
             const bool drawTrianglePoints = polygonModeMask & static_cast<std::uint32_t>(PolygonMode::POINT);
             const bool useDDA = rasterizationRuleMask & static_cast<std::uint32_t>(RasterizationRule::DDA);
 
-            if (drawTriangleFill) {
-                const auto shader = shade(v0, v1, v2, uv0, uv1, uv2, triangle.colors, triangle.surface);
-                if (useDDA) {
-                    sortAscendingVertically(v0, v1, v2, p0, p1, p2, uv0, uv1, uv2);
-                    drawTriangleDDA(v0, v1, v2, p0, p1, p2, shader);
+            if (drawTriangleFill && (setup == TriangleSetup::MICRO || setup == TriangleSetup::REGULAR)) {
+                // Shaders are statically dispatched, type-erasing them would heap allocate per triangle
+                const auto fill = [&](const auto& shader) {
+                    if (setup == TriangleSetup::MICRO) {
+                        drawMicroTriangle(v0, v1, v2, shader, rows, fragments);
+                    } else if (useDDA) {
+                        sortAscendingVertically(v0, v1, v2, p0, p1, p2, uv0, uv1, uv2);
+                        drawTriangleDDA(v0, v1, v2, p0, p1, p2, shader, rows, fragments);
+                    } else {
+                        drawTriangleTopLeft(v0, v1, v2, shader, rows, fragments);
+                    }
+                };
+
+                // Untextured without a surface
+                if (fillModeMask & static_cast<std::uint32_t>(FillMode::VERTEX_COLOR) || triangle.surface == nullptr) {
+                    fill(VertexColorShader{triangle.colors});
                 } else {
-                    drawTriangleTopLeft(v0, v1, v2, shader);
+                    fill(TextureShader{v0, v1, v2, uv0, uv1, uv2, triangle.surface});
                 }
             }
 
             if (drawTrianglePoints) {
-                drawPoint(p0, trianglePointColor);
-                drawPoint(p1, trianglePointColor);
-                drawPoint(p2, trianglePointColor);
+                drawPoint(p0, trianglePointColor, rows);
+                drawPoint(p1, trianglePointColor, rows);
+                drawPoint(p2, trianglePointColor, rows);
             }
 
             if (drawTriangleLines) {
-                drawLine(p0, p1, triangleLineColor);
-                drawLine(p0, p2, triangleLineColor);
-                drawLine(p1, p2, triangleLineColor);
+                drawLine(p0, p1, triangleLineColor, rows);
+                drawLine(p0, p2, triangleLineColor, rows);
+                drawLine(p1, p2, triangleLineColor, rows);
             }
         }
 
@@ -219,6 +377,18 @@ namespace rasterizer {
                         : static_cast<std::int32_t>(RasterizationRule::TOP_LEFT)) - 1;
         }
 
+        // Identifies the polygon modes, fill mode and rasterization rule, changes whenever any of them does
+        std::uint32_t modes() const {
+            return polygonModeMask | fillModeMask << 8 | rasterizationRuleMask << 16;
+        }
+
+        RowRange allRows() const {
+            return {0, static_cast<std::int32_t>(height)};
+        }
+
+        // Measures the private kernels in isolation, see tools/microbench.cpp
+        friend struct CanvasKernels;
+
     private:
         std::unique_ptr<SDL_Texture, decltype(&SDL_DestroyTexture)> framebufferTexture{nullptr, SDL_DestroyTexture};
         /*
@@ -227,6 +397,9 @@ namespace rasterizer {
          * Cannot use std::array as size is not known at compile time
          */
         color_t* colorBuffer = nullptr;
+        // Where pixels are drawn, colorBuffer unless an external target is attached
+        color_t* colorTarget = nullptr;
+        std::uint32_t colorTargetStride = 0;
         glm::float32_t* depthBuffer = nullptr;
 
         std::uint32_t polygonModeMask = static_cast<std::uint32_t>(PolygonMode::FILL) |
@@ -251,24 +424,24 @@ namespace rasterizer {
             return framebufferTexture;
         }
 
-        static color_t* createColorBuffer(const std::uint32_t width, const std::uint32_t height) {
-            return static_cast<color_t*>(std::calloc(width * height, sizeof(color_t)));
-        }
-
         static glm::float32_t* createDepthBuffer(const std::uint32_t width, const std::uint32_t height) {
             return static_cast<glm::float32_t*>(std::calloc(width * height, sizeof(color_t)));
         }
 
         void setDepth(const std::int32_t row, const std::int32_t column, const glm::float32_t depth) const {
-            if (0 <= row && row < height && 0 <= column && column < width) {
+            if (0 <= row && row < static_cast<std::int32_t>(height) &&
+                0 <= column && column < static_cast<std::int32_t>(width)) {
                 depthBuffer[row * width + column] = depth;
             }
         }
 
+        template<typename ColorShader>
         void drawBarycentricPixel(const std::int32_t row, const std::int32_t column,
                                   const glm::vec4& v0, const glm::vec4& v1, const glm::vec4& v2,
-                                  const glm::vec3& barycentricWeights, const ColorShader& shader) const {
-            if (row < 0 || row >= height || column < 0 || column >= width) {
+                                  const glm::vec3& barycentricWeights, const ColorShader& shader,
+                                  FragmentCounters& fragments) const {
+            if (row < 0 || row >= static_cast<std::int32_t>(height) ||
+                column < 0 || column >= static_cast<std::int32_t>(width)) {
                 return;
             }
 
@@ -284,39 +457,43 @@ namespace rasterizer {
             const glm::float32_t normalizedDepth = 1.0f - wReciprocalInterpolated;
 
             // If value is further away, we avoid drawing
+            fragments.tested++;
             if (normalizedDepth >= depthBuffer[row * width + column]) {
                 return;
             }
+            fragments.passed++;
 
             drawPixel(row, column, shader(barycentricWeights, wReciprocalInterpolated));
             setDepth(row, column, normalizedDepth);
         }
 
         ///////////////////////////////////////////////////////////////////////////////
-        //
-        //            p0
-        //            / \
-        //           /   \
-        //          /     \
-        //         /       \
-        //        /         \
-        //      p1 -------- mid
-        //       \_           \
-        //          \_         \
-        //             \_       \
-        //                \_     \
-        //                   \    \
-        //                     \_  \
-        //                        \_\
-        //                           \
-        //                           p2
-        //
-        // Based on diagram by: Pikuma (Gustavo Pezzi)
-        //
+        /*
+         *            p0
+         *            / \
+         *           /   \
+         *          /     \
+         *         /       \
+         *        /         \
+         *      p1 -------- mid
+         *       \_           \
+         *          \_         \
+         *             \_       \
+         *                \_     \
+         *                   \    \
+         *                     \_  \
+         *                        \_\
+         *                           \
+         *                           p2
+         *
+         * Based on diagram by: Pikuma (Gustavo Pezzi)
+         */
         ///////////////////////////////////////////////////////////////////////////////
+        template<typename ColorShader>
         void drawTriangleDDA(const glm::vec4& v0, const glm::vec4& v1, const glm::vec4& v2,
                              const glm::ivec2& p0, const glm::ivec2& p1, const glm::ivec2& p2,
-                             const ColorShader& shader) const {
+                             const ColorShader& shader, const RowRange& rows,
+                             FragmentCounters& fragments) const {
             // Compute inverse slopes 0 -> 1 and 0 -> 2
             glm::float32_t invSlope01 = 0.0f;
             glm::float32_t invSlope02 = 0.0f;
@@ -330,7 +507,7 @@ namespace rasterizer {
 
             // Draw flat-bottom triangle
             if (p1.y - p0.y != 0) {
-                for (std::int32_t y = p0.y; y <= p1.y; ++y) {
+                for (std::int32_t y = std::max(p0.y, rows.begin); y <= std::min(p1.y, rows.end - 1); ++y) {
                     std::int32_t xStart = p1.x + (y - p1.y) * invSlope01;
                     std::int32_t xEnd = p0.x + (y - p0.y) * invSlope02;
 
@@ -340,7 +517,8 @@ namespace rasterizer {
                     }
 
                     for (std::int32_t x = xStart; x < xEnd; ++x) {
-                        drawBarycentricPixel(y, x, v0, v1, v2, barycentricWeights(p0, p1, p2, {x, y}), shader);
+                        drawBarycentricPixel(y, x, v0, v1, v2, barycentricWeights(p0, p1, p2, {x, y}), shader,
+                                             fragments);
                     }
                 }
             }
@@ -354,7 +532,7 @@ namespace rasterizer {
 
             // Draw flat-top triangle
             if (p2.y - p1.y != 0) {
-                for (std::int32_t y = p1.y; y <= p2.y; ++y) {
+                for (std::int32_t y = std::max(p1.y, rows.begin); y <= std::min(p2.y, rows.end - 1); ++y) {
                     std::int32_t xStart = p1.x + (y - p1.y) * invSlope12;
                     std::int32_t xEnd = p0.x + (y - p0.y) * invSlope02;
 
@@ -364,19 +542,24 @@ namespace rasterizer {
                     }
 
                     for (std::int32_t x = xStart; x < xEnd; ++x) {
-                        drawBarycentricPixel(y, x, v0, v1, v2, barycentricWeights(p0, p1, p2, {x, y}), shader);
+                        drawBarycentricPixel(y, x, v0, v1, v2, barycentricWeights(p0, p1, p2, {x, y}), shader,
+                                             fragments);
                     }
                 }
             }
         }
 
+        template<typename ColorShader>
         void drawTriangleTopLeft(const glm::vec4& v0, const glm::vec4& v1, const glm::vec4& v2,
-                                 const ColorShader& shader) const {
+                                 const ColorShader& shader, const RowRange& rows,
+                                 FragmentCounters& fragments) const {
             // Take bounding-box boundaries
             const auto xMin = static_cast<std::int32_t>(std::floor(std::min(std::min(v0.x, v1.x), v2.x)));
-            const auto yMin = static_cast<std::int32_t>(std::floor(std::min(std::min(v0.y, v1.y), v2.y)));
+            const auto yMin = std::max(static_cast<std::int32_t>(std::floor(std::min(std::min(v0.y, v1.y), v2.y))),
+                                       rows.begin);
             const auto xMax = static_cast<std::int32_t>(std::ceil(std::max(std::max(v0.x, v1.x), v2.x)));
-            const auto yMax = static_cast<std::int32_t>(std::ceil(std::max(std::max(v0.y, v1.y), v2.y)));
+            const auto yMax = std::min(static_cast<std::int32_t>(std::ceil(std::max(std::max(v0.y, v1.y), v2.y))),
+                                       rows.end);
 
             // Compute the constant deltas that will be used for the horizontal and vertical steps
             // Constants across iteration
@@ -419,7 +602,7 @@ namespace rasterizer {
                         const auto beta = w2 / area;
                         const auto gamma = w0 / area;
 
-                        drawBarycentricPixel(row, column, v0, v1, v2, {alpha, beta, gamma}, shader);
+                        drawBarycentricPixel(row, column, v0, v1, v2, {alpha, beta, gamma}, shader, fragments);
                     }
                     w0 += w0DeltaColumn;
                     w1 += w1DeltaColumn;
@@ -431,6 +614,48 @@ namespace rasterizer {
             }
         }
 
+        // Top-left rule for triangles covering at most 2x2 samples, edge functions are evaluated per sample
+        // instead of setting up incremental row and column steps
+        template<typename ColorShader>
+        void drawMicroTriangle(const glm::vec4& v0, const glm::vec4& v1, const glm::vec4& v2,
+                               const ColorShader& shader, const RowRange& rows,
+                               FragmentCounters& fragments) const {
+            const auto [first, last] = sampleBounds(v0, v1, v2);
+            const glm::float32_t area = edgeCross(v0, v1, v2);
+
+            const glm::float32_t bias0 = isTopLeft(v0, v1) ? 0.0f : -0.0001f;
+            const glm::float32_t bias1 = isTopLeft(v1, v2) ? 0.0f : -0.0001f;
+            const glm::float32_t bias2 = isTopLeft(v2, v0) ? 0.0f : -0.0001f;
+
+            for (std::int32_t row = std::max(first.y, rows.begin); row <= std::min(last.y, rows.end - 1); ++row) {
+                for (std::int32_t column = first.x; column <= last.x; ++column) {
+                    const glm::vec2 p{static_cast<glm::float32_t>(column) + 0.5f,
+                                      static_cast<glm::float32_t>(row) + 0.5f};
+                    const glm::float32_t w0 = edgeCross(v0, v1, p) + bias0;
+                    const glm::float32_t w1 = edgeCross(v1, v2, p) + bias1;
+                    const glm::float32_t w2 = edgeCross(v2, v0, p) + bias2;
+
+                    if (w0 >= 0 && w1 >= 0 && w2 >= 0) {
+                        drawBarycentricPixel(row, column, v0, v1, v2, {w1 / area, w2 / area, w0 / area}, shader,
+                                             fragments);
+                    }
+                }
+            }
+        }
+
+        // First and last pixel whose center lies within the triangle bounding box, clamped to the canvas
+        std::pair<glm::ivec2, glm::ivec2> sampleBounds(const glm::vec4& v0, const glm::vec4& v1,
+                                                       const glm::vec4& v2) const {
+            const glm::vec2 min = glm::min(glm::min(glm::vec2{v0}, glm::vec2{v1}), glm::vec2{v2});
+            const glm::vec2 max = glm::max(glm::max(glm::vec2{v0}, glm::vec2{v1}), glm::vec2{v2});
+
+            return {
+                glm::max(glm::ivec2{glm::ceil(min - 0.5f)}, glm::ivec2{0}),
+                glm::min(glm::ivec2{glm::floor(max - 0.5f)},
+                         glm::ivec2{static_cast<std::int32_t>(width) - 1, static_cast<std::int32_t>(height) - 1})
+            };
+        }
+
         static void sortAscendingVertically(glm::vec4& v0, glm::vec4& v1, glm::vec4& v2,
                                             glm::ivec2& p0, glm::ivec2& p1, glm::ivec2& p2) {
             // Sort such that p0.y <= p1.y <= p2.y
@@ -477,26 +702,26 @@ namespace rasterizer {
         }
 
         ///////////////////////////////////////////////////////////////////////////////
-        //
-        // Return the barycentric weights alpha, beta, and gamma for point p
-        //
-        //         (B)
-        //         /|\
-        //        / | \
-        //       /  |  \
-        //      /  (P)  \
-        //     /  /   \  \
-        //    / /       \ \
-        //   //           \\
-        //  (A)------------(C)
-        //
-        // Based on diagram by: Pikuma (Gustavo Pezzi)
-        //
-        // Points are fed in as integers but barycentric are computed using floats.
-        // Therefore, the vertices can get rounded _outside_ of the triangle.
-        // This can break the condition 0 <= α, β, γ <= 1 && α + β + γ = 1.
-        // Users must guard against this.
-        //
+        /*
+         * Return the barycentric weights alpha, beta, and gamma for point p
+         *
+         *         (B)
+         *         /|\
+         *        / | \
+         *       /  |  \
+         *      /  (P)  \
+         *     /  /   \  \
+         *    / /       \ \
+         *   //           \\
+         *  (A)------------(C)
+         *
+         * Based on diagram by: Pikuma (Gustavo Pezzi)
+         *
+         * Points are fed in as integers but barycentric are computed using floats.
+         * Therefore, the vertices can get rounded _outside_ of the triangle.
+         * This can break the condition 0 <= α, β, γ <= 1 && α + β + γ = 1.
+         * Users must guard against this.
+         */
         ///////////////////////////////////////////////////////////////////////////////
         static glm::vec3 barycentricWeights(const glm::ivec2& a, const glm::ivec2& b, const glm::ivec2& c,
                                             const glm::ivec2& p) {
@@ -548,21 +773,23 @@ namespace rasterizer {
             return isTopEdge || isLeftEdge;
         }
 
-        ColorShader shade(const glm::vec4& v0, const glm::vec4& v1, const glm::vec4& v2,
-                          const glm::vec2& uv0, const glm::vec2& uv1, const glm::vec2& uv2,
-                          const std::array<color_t, 3>& colors, const Surface* surface) const {
-            const bool triangleFillVertexColor = fillModeMask & static_cast<std::uint32_t>(FillMode::VERTEX_COLOR);
-            if (triangleFillVertexColor) {
-                return [&colors](const glm::vec3& weights, auto...) {
-                    return rasterizer::interpolateColor(weights, colors);
-                };
-            } else {
-                return [&v0, &v1, &v2, &uv0, &uv1, &uv2, surface](const glm::vec3& weights,
-                                                                  const glm::float32_t wReciprocal) {
-                    return textureColoring(v0, v1, v2, uv0, uv1, uv2, weights, wReciprocal, surface);
-                };
+        struct VertexColorShader {
+            const std::array<color_t, 3>& colors;
+
+            color_t operator()(const glm::vec3& weights, const glm::float32_t) const {
+                return rasterizer::interpolateColor(weights, colors);
             }
-        }
+        };
+
+        struct TextureShader {
+            const glm::vec4 &v0, &v1, &v2;
+            const glm::vec2 &uv0, &uv1, &uv2;
+            const Surface* surface;
+
+            color_t operator()(const glm::vec3& weights, const glm::float32_t wReciprocal) const {
+                return textureColoring(v0, v1, v2, uv0, uv1, uv2, weights, wReciprocal, surface);
+            }
+        };
 
         static color_t vertexColoring(const glm::vec3 weights, const std::array<color_t, 3>& colors) {
             return rasterizer::interpolateColor(weights, colors);
@@ -34,6 +34,6 @@ namespace rasterizer {
             weights.z * (colors[2] & 0x0000FF00)
         );
 
-        return r & 0xFF000000 | g & 0x00FF0000 | b & 0x0000FF00 | 0x000000FF;
+        return (r & 0xFF000000) | (g & 0x00FF0000) | (b & 0x0000FF00) | 0x000000FF;
     }
 }
@@ -71,9 +71,16 @@ namespace rasterizer {
             // Render frame
             const auto update = SDL_UpdateTexture(framebufferTexture, nullptr,
                                                   framebuffer, static_cast<int>(sizeof(color_t) * framebufferStride));
-            const auto renderCopy = SDL_RenderCopy(renderer.get(), framebufferTexture, nullptr, nullptr);
+            if (update != EXIT_SUCCESS) {
+                throw std::runtime_error("Failed to render frame");
+            }
+
+            render(framebufferTexture);
+        }
 
-            if (update != EXIT_SUCCESS || renderCopy != EXIT_SUCCESS) {
+        // Frame already in the texture, drawn while it was locked
+        void render(SDL_Texture* framebufferTexture) const {
+            if (SDL_RenderCopy(renderer.get(), framebufferTexture, nullptr, nullptr) != EXIT_SUCCESS) {
                 throw std::runtime_error("Failed to render frame");
             }
         }
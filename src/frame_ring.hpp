@@ -0,0 +1,289 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define RASTERIZER_HAS_SHARED_MEMORY 1
+#else
+#define RASTERIZER_HAS_SHARED_MEMORY 0
+#endif
+
+namespace rasterizer {
+    // Start of the shared memory object, followed by slotsAmount FrameRingSlot, then the pixels of every slot
+    // Frame n is in slot n % slotsAmount, the published and released counters are the only synchronization
+    struct FrameRingHeader {
+        static constexpr std::array<char, 8> MAGIC{'R', 'F', 'R', 'A', 'M', 'E', 'S', '\0'};
+        static constexpr std::uint32_t VERSION = 1;
+
+        enum State : std::uint32_t {
+            INITIALIZING,
+            OPEN,
+            // No frame is published anymore
+            CLOSED,
+        };
+
+        std::array<char, 8> magic;
+        std::uint32_t version;
+        std::uint32_t slotsAmount;
+        std::uint32_t width, height;
+        // SDL_PixelFormatEnum, 32 bits per pixel
+        std::uint32_t pixelFormat;
+        // Bytes per row
+        std::uint32_t pitch;
+        std::uint64_t slotBytes;
+        std::uint64_t pixelsOffset;
+
+        // Released by the producer once the fields above are written
+        alignas(64) std::atomic<std::uint32_t> state;
+        // Frames published by the producer
+        alignas(64) std::atomic<std::uint64_t> produced;
+        // Frames released by the consumer
+        alignas(64) std::atomic<std::uint64_t> consumed;
+    };
+
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "Shared counters must be address free");
+
+    // Written by the producer before the frame is published
+    struct FrameRingSlot {
+        std::uint64_t frame;
+        // std::chrono::steady_clock, in nanoseconds
+        std::int64_t timestamp;
+    };
+
+    // Single producer, single consumer ring of frames in POSIX shared memory, frames are never copied
+    // A full ring blocks the producer
+    class FrameRing {
+    public:
+        static constexpr std::uint32_t DEFAULT_SLOTS_AMOUNT = 4;
+
+        // Producer side, replaces any leftover object called name (which must start with '/')
+        static FrameRing create(const std::string& name, const std::uint32_t width, const std::uint32_t height,
+                                const std::uint32_t pixelFormat,
+                                const std::uint32_t slotsAmount = DEFAULT_SLOTS_AMOUNT) {
+            const std::uint32_t pitch = width * sizeof(std::uint32_t);
+            // Slots are page aligned, so that every frame starts on its own pages
+            const std::size_t slotBytes = alignTo(static_cast<std::size_t>(pitch) * height, PAGE_ALIGNMENT);
+            const std::size_t pixelsOffset =
+                alignTo(sizeof(FrameRingHeader) + slotsAmount * sizeof(FrameRingSlot), PAGE_ALIGNMENT);
+
+            FrameRing ring(name, pixelsOffset + slotsAmount * slotBytes, true);
+
+            auto* header = new(ring.bytes) FrameRingHeader{
+                .magic = FrameRingHeader::MAGIC, .version = FrameRingHeader::VERSION,
+                .slotsAmount = slotsAmount, .width = width, .height = height,
+                .pixelFormat = pixelFormat, .pitch = pitch,
+                .slotBytes = slotBytes, .pixelsOffset = pixelsOffset,
+                .state = FrameRingHeader::INITIALIZING, .produced = 0, .consumed = 0
+            };
+            header->state.store(FrameRingHeader::OPEN, std::memory_order_release);
+
+            return ring;
+        }
+
+        // Consumer side, nullopt until the producer has created the ring
+        static std::optional<FrameRing> open(const std::string& name) {
+#if RASTERIZER_HAS_SHARED_MEMORY
+            const int descriptor = ::shm_open(name.c_str(), O_RDWR, 0);
+            if (descriptor < 0) {
+                return std::nullopt;
+            }
+            struct stat status{};
+            const bool hasHeader = ::fstat(descriptor, &status) == 0
+                                   && static_cast<std::size_t>(status.st_size) >= sizeof(FrameRingHeader);
+            ::close(descriptor);
+            if (!hasHeader) {
+                return std::nullopt;
+            }
+
+            FrameRing ring(name, static_cast<std::size_t>(status.st_size), false);
+            const auto& header = ring.header();
+            if (header.state.load(std::memory_order_acquire) == FrameRingHeader::INITIALIZING) {
+                return std::nullopt;
+            }
+            if (header.magic != FrameRingHeader::MAGIC || header.version != FrameRingHeader::VERSION
+                || header.pixelsOffset + header.slotsAmount * header.slotBytes > ring.size) {
+                throw std::runtime_error("Not a compatible frame ring: " + name);
+            }
+
+            return ring;
+#else
+            throw std::runtime_error("Shared memory frame rings are not supported on this platform: " + name);
+#endif
+        }
+
+        FrameRing(FrameRing&& other) noexcept
+            : name(std::move(other.name)), bytes(std::exchange(other.bytes, nullptr)),
+              size(std::exchange(other.size, 0)), isOwner(std::exchange(other.isOwner, false)) {
+        }
+
+        FrameRing(const FrameRing&) = delete;
+        FrameRing& operator=(const FrameRing&) = delete;
+        FrameRing& operator=(FrameRing&&) = delete;
+
+        ~FrameRing() {
+#if RASTERIZER_HAS_SHARED_MEMORY
+            if (bytes == nullptr) {
+                return;
+            }
+            if (isOwner) {
+                close();
+                // Consumers keep their mapping, the name is free for the next producer
+                ::shm_unlink(name.c_str());
+            }
+            ::munmap(bytes, size);
+#endif
+        }
+
+        const FrameRingHeader& header() const {
+            return *reinterpret_cast<const FrameRingHeader*>(bytes);
+        }
+
+        // Producer: blocks until the slot of the next frame is released, returns its pixels, or nullptr once closed
+        std::uint32_t* acquireSlot() {
+            auto& header = mutableHeader();
+            const std::uint64_t frame = header.produced.load(std::memory_order_relaxed);
+            waitUntil([&] {
+                return isClosed() || frame - header.consumed.load(std::memory_order_acquire) < header.slotsAmount;
+            });
+
+            return isClosed() ? nullptr : pixels(frame);
+        }
+
+        // Producer: hands the frame in the acquired slot over to the consumer
+        void publish(const std::uint64_t frame) {
+            auto& header = mutableHeader();
+            const std::uint64_t sequence = header.produced.load(std::memory_order_relaxed);
+            slots()[sequence % header.slotsAmount] = FrameRingSlot{
+                .frame = frame,
+                .timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count()
+            };
+            header.produced.store(sequence + 1, std::memory_order_release);
+        }
+
+        // Async-signal-safe, the state is a lock-free atomic
+        void close() noexcept {
+            mutableHeader().state.store(FrameRingHeader::CLOSED, std::memory_order_release);
+        }
+
+        bool isClosed() const {
+            return header().state.load(std::memory_order_acquire) == FrameRingHeader::CLOSED;
+        }
+
+        struct Frame {
+            FrameRingSlot slot;
+            std::span<const std::uint32_t> pixels;
+        };
+
+        // Consumer: blocks until a frame is published, nullopt once the ring is closed and drained
+        std::optional<Frame> acquireFrame() {
+            auto& header = mutableHeader();
+            const std::uint64_t sequence = header.consumed.load(std::memory_order_relaxed);
+            bool isClosed = false;
+            waitUntil([&] {
+                // Read before produced: a frame published right before closing is still seen
+                isClosed = header.state.load(std::memory_order_acquire) == FrameRingHeader::CLOSED;
+                return sequence < header.produced.load(std::memory_order_acquire) || isClosed;
+            });
+            if (sequence == header.produced.load(std::memory_order_acquire)) {
+                return std::nullopt;
+            }
+
+            const std::size_t pixelsAmount = header.pitch / sizeof(std::uint32_t) * header.height;
+            return Frame{.slot = slots()[sequence % header.slotsAmount], .pixels = {pixels(sequence), pixelsAmount}};
+        }
+
+        // Consumer: the slot of the acquired frame can be rendered into again
+        void releaseFrame() {
+            auto& header = mutableHeader();
+            header.consumed.store(header.consumed.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+    private:
+        static constexpr std::size_t PAGE_ALIGNMENT = 4096;
+
+        std::string name;
+        std::byte* bytes = nullptr;
+        std::size_t size = 0;
+        // The producer creates and removes the shared memory object
+        bool isOwner = false;
+
+        FrameRing(std::string name, const std::size_t size, const bool isOwner)
+            : name(std::move(name)), size(size), isOwner(isOwner) {
+#if RASTERIZER_HAS_SHARED_MEMORY
+            if (isOwner) {
+                ::shm_unlink(this->name.c_str());
+            }
+            const int descriptor = isOwner
+                                       ? ::shm_open(this->name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600)
+                                       : ::shm_open(this->name.c_str(), O_RDWR, 0);
+            if (descriptor < 0) {
+                throw std::runtime_error("Failed to open shared memory: " + this->name);
+            }
+            if (isOwner && ::ftruncate(descriptor, static_cast<off_t>(size)) != 0) {
+                ::close(descriptor);
+                ::shm_unlink(this->name.c_str());
+                throw std::runtime_error("Failed to size shared memory: " + this->name);
+            }
+
+            void* mapping = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+            // The mapping outlives the descriptor
+            ::close(descriptor);
+            if (mapping == MAP_FAILED) {
+                if (isOwner) {
+                    ::shm_unlink(this->name.c_str());
+                }
+                throw std::runtime_error("Failed to map shared memory: " + this->name);
+            }
+            bytes = static_cast<std::byte*>(mapping);
+#else
+            throw std::runtime_error("Shared memory frame rings are not supported on this platform: " + this->name);
+#endif
+        }
+
+        static std::size_t alignTo(const std::size_t offset, const std::size_t alignment) {
+            return (offset + alignment - 1) / alignment * alignment;
+        }
+
+        // Spins briefly, then sleeps: futexes are process private, so waits cannot be woken across processes
+        template<typename Predicate>
+        static void waitUntil(const Predicate& isReady) {
+            for (std::uint32_t attempt = 0; !isReady(); ++attempt) {
+                if (attempt < 64) {
+                    std::this_thread::yield();
+                } else {
+                    std::this_thread::sleep_for(std::chrono::microseconds(100));
+                }
+            }
+        }
+
+        FrameRingHeader& mutableHeader() {
+            return *reinterpret_cast<FrameRingHeader*>(bytes);
+        }
+
+        FrameRingSlot* slots() {
+            return reinterpret_cast<FrameRingSlot*>(bytes + sizeof(FrameRingHeader));
+        }
+
+        std::uint32_t* pixels(const std::uint64_t sequence) {
+            const auto& header = this->header();
+            return reinterpret_cast<std::uint32_t*>(
+                bytes + header.pixelsOffset + (sequence % header.slotsAmount) * header.slotBytes);
+        }
+    };
+}
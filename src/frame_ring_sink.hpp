@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "canvas.hpp"
+#include "color.hpp"
+#include "frame_ring.hpp"
+#include "frame_sink.hpp"
+
+namespace rasterizer {
+    // Renders every frame straight into a shared memory FrameRing slot, for a consumer in another process
+    class FrameRingSink final : public FrameSink {
+    public:
+        FrameRingSink(const std::string& name, const std::uint32_t width, const std::uint32_t height,
+                      const std::uint32_t slotsAmount = FrameRing::DEFAULT_SLOTS_AMOUNT)
+            : ring(FrameRing::create(name, width, height, colorFormat, slotsAmount)) {
+        }
+
+        void prepare(Canvas& canvas) override {
+            if (canvas.width != ring.header().width || canvas.height != ring.header().height) {
+                throw std::runtime_error("FrameRingSink size does not match the canvas");
+            }
+            // Once interrupted, the frame is drawn into the canvas and dropped
+            if (std::uint32_t* slot = ring.acquireSlot()) {
+                canvas.attachColorTarget(slot);
+            }
+        }
+
+        void consume(Canvas& canvas, const std::uint64_t frame) override {
+            canvas.detachColorTarget();
+            if (!ring.isClosed()) {
+                ring.publish(frame);
+            }
+        }
+
+        void finish() override {
+            ring.close();
+        }
+
+        // The producer stops waiting for the consumer to release slots
+        void interrupt() noexcept override {
+            ring.close();
+        }
+
+    private:
+        FrameRing ring;
+    };
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+
+#include "canvas.hpp"
+
+namespace rasterizer {
+    /*
+     * Destination of the frames rendered in headless mode.
+     * consume is called on the render thread once per finished frame, and the canvas is not drawn to again
+     * until it returns.
+     */
+    class FrameSink {
+    public:
+        virtual ~FrameSink() = default;
+
+        // Called on the render thread before a frame is drawn
+        virtual void prepare(Canvas&) {
+        }
+
+        virtual void consume(Canvas& canvas, std::uint64_t frame) = 0;
+
+        // Called once after the last frame of a run with a frame amount, blocks until every frame is consumed
+        virtual void finish() {
+        }
+
+        // Called from a signal handler to end the run early, must be async-signal-safe
+        virtual void interrupt() noexcept {
+        }
+    };
+
+    // Drops every frame, throughput is then bound by rendering alone
+    class DiscardFrameSink final : public FrameSink {
+    public:
+        void consume(Canvas&, std::uint64_t) override {
+        }
+    };
+}
@@ -0,0 +1,241 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <SDL2/SDL_image.h>
+
+#include "arena.hpp"
+#include "canvas.hpp"
+#include "color.hpp"
+#include "frame_sink.hpp"
+
+namespace rasterizer {
+    enum class ImageFormat : std::uint8_t {
+        // Binary portable pixmap, 8-bit RGB
+        PPM,
+        // Headerless colorFormat pixels, row after row
+        RAW,
+        PNG,
+    };
+
+    inline const char* imageExtension(const ImageFormat format) {
+        switch (format) {
+            case ImageFormat::PPM:
+                return ".ppm";
+            case ImageFormat::RAW:
+                return ".raw";
+            case ImageFormat::PNG:
+                return ".png";
+        }
+        return "";
+    }
+
+    /*
+     * Writes every frame to directory as frame_000000.ext, on a background thread.
+     * The finished color buffer is taken from the canvas and replaced by a recycled one, so rendering the next frame
+     * overlaps encoding and writing the previous ones. Once queueCapacity frames are pending the render thread
+     * blocks until the oldest one is written, which bounds memory to queueCapacity + 1 color buffers.
+     */
+    class FrameWriter final : public FrameSink {
+    public:
+        static constexpr std::size_t DEFAULT_QUEUE_CAPACITY = 4;
+
+        FrameWriter(std::filesystem::path directory, const ImageFormat format,
+                    const std::size_t queueCapacity = DEFAULT_QUEUE_CAPACITY)
+            : directory(std::move(directory)), format(format), queueCapacity(std::max(queueCapacity, std::size_t{1})) {
+            std::filesystem::create_directories(this->directory);
+            writer = std::thread([this] { write(); });
+        }
+
+        ~FrameWriter() override {
+            stop();
+            if (error != nullptr) {
+                try {
+                    std::rethrow_exception(error);
+                } catch (const std::exception& e) {
+                    rasterizer::print(std::cerr, "Frames could not be written: {}\n", e.what());
+                }
+            }
+        }
+
+        FrameWriter(const FrameWriter&) = delete;
+        FrameWriter& operator=(const FrameWriter&) = delete;
+
+        void consume(Canvas& canvas, const std::uint64_t frame) override {
+            ColorBuffer spare{nullptr, std::free};
+            {
+                std::unique_lock lock(mutex);
+                frameWritten.wait(lock, [this] { return pendingAmount < queueCapacity || error != nullptr; });
+                rethrowError();
+
+                if (!recycled.empty()) {
+                    spare = std::move(recycled.back());
+                    recycled.pop_back();
+                }
+            }
+
+            if (spare == nullptr) {
+                spare.reset(Canvas::createColorBuffer(canvas.width, canvas.height));
+                if (spare == nullptr) {
+                    throw std::runtime_error("Failed to create FrameWriter color buffer");
+                }
+            }
+
+            PendingFrame pending{
+                .frame = frame, .width = canvas.width, .height = canvas.height,
+                .pixels = ColorBuffer(canvas.exchangeColorBuffer(spare.release()), std::free)
+            };
+            {
+                std::lock_guard lock(mutex);
+                queue.push_back(std::move(pending));
+                pendingAmount++;
+            }
+            framePending.notify_one();
+        }
+
+        // Blocks until every frame is on disk
+        void finish() override {
+            stop();
+            rethrowError();
+        }
+
+    private:
+        using ColorBuffer = std::unique_ptr<color_t, decltype(&std::free)>;
+
+        struct PendingFrame {
+            std::uint64_t frame;
+            std::uint32_t width, height;
+            ColorBuffer pixels;
+        };
+
+        const std::filesystem::path directory;
+        const ImageFormat format;
+        const std::size_t queueCapacity;
+
+        std::mutex mutex;
+        std::condition_variable framePending;
+        std::condition_variable frameWritten;
+        std::deque<PendingFrame> queue;
+        // Queued plus the one being written
+        std::size_t pendingAmount = 0;
+        std::vector<ColorBuffer> recycled;
+        std::exception_ptr error = nullptr;
+        bool isStopping = false;
+
+        std::thread writer;
+
+        void stop() {
+            {
+                std::lock_guard lock(mutex);
+                isStopping = true;
+            }
+            framePending.notify_one();
+
+            if (writer.joinable()) {
+                writer.join();
+            }
+        }
+
+        void rethrowError() {
+            if (error != nullptr) {
+                std::rethrow_exception(std::exchange(error, nullptr));
+            }
+        }
+
+        void write() {
+            const UncountedAllocations writing;
+            // Only touched by the writer thread
+            std::vector<std::uint8_t> encoded;
+
+            while (true) {
+                std::optional<PendingFrame> pending;
+                {
+                    std::unique_lock lock(mutex);
+                    framePending.wait(lock, [this] { return isStopping || !queue.empty(); });
+                    // Pending frames are still written when stopping
+                    if (queue.empty()) {
+                        return;
+                    }
+                    pending.emplace(std::move(queue.front()));
+                    queue.pop_front();
+                }
+
+                std::exception_ptr writeError = nullptr;
+                try {
+                    writeFrame(*pending, encoded);
+                } catch (...) {
+                    writeError = std::current_exception();
+                }
+
+                {
+                    std::lock_guard lock(mutex);
+                    pendingAmount--;
+                    recycled.push_back(std::move(pending->pixels));
+                    if (writeError != nullptr && error == nullptr) {
+                        error = writeError;
+                    }
+                }
+                frameWritten.notify_one();
+            }
+        }
+
+        void writeFrame(const PendingFrame& pending, std::vector<std::uint8_t>& encoded) const {
+            const auto path = directory / std::format("frame_{:06}{}", pending.frame, imageExtension(format));
+            const std::size_t pixelsAmount = static_cast<std::size_t>(pending.width) * pending.height;
+
+            if (format == ImageFormat::PNG) {
+                SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormatFrom(
+                    pending.pixels.get(), static_cast<int>(pending.width), static_cast<int>(pending.height),
+                    sizeof(color_t) * 8, static_cast<int>(pending.width * sizeof(color_t)), colorFormat
+                );
+                if (surface == nullptr) {
+                    throw std::runtime_error(std::format("SDL_CreateRGBSurfaceWithFormatFrom Error: {}",
+                                                         SDL_GetError()));
+                }
+                const int result = IMG_SavePNG(surface, path.string().c_str());
+                SDL_FreeSurface(surface);
+                if (result != 0) {
+                    throw std::runtime_error(std::format("IMG_SavePNG Error: {}", IMG_GetError()));
+                }
+                return;
+            }
+
+            std::ofstream file(path, std::ios::binary | std::ios::trunc);
+            if (format == ImageFormat::PPM) {
+                file << std::format("P6\n{} {}\n255\n", pending.width, pending.height);
+
+                // colorFormat is 0xRRGGBBAA
+                encoded.resize(pixelsAmount * 3);
+                for (std::size_t i = 0; i < pixelsAmount; ++i) {
+                    const color_t color = pending.pixels.get()[i];
+                    encoded[i * 3 + 0] = static_cast<std::uint8_t>(color >> 24);
+                    encoded[i * 3 + 1] = static_cast<std::uint8_t>(color >> 16);
+                    encoded[i * 3 + 2] = static_cast<std::uint8_t>(color >> 8);
+                }
+                file.write(reinterpret_cast<const char*>(encoded.data()), static_cast<std::streamsize>(encoded.size()));
+            } else {
+                file.write(reinterpret_cast<const char*>(pending.pixels.get()),
+                           static_cast<std::streamsize>(pixelsAmount * sizeof(color_t)));
+            }
+
+            if (!file.good()) {
+                throw std::runtime_error("Failed to write frame: " + path.string());
+            }
+        }
+    };
+}
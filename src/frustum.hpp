@@ -80,6 +80,17 @@ namespace rasterizer {
             return polygon;
         }
 
+        bool isSphereOutside(const glm::vec3& center, const glm::float32_t radius) const {
+            // Sphere is outside if it lies entirely on the outer side of any plane
+            for (const auto& [point, normal] : planes) {
+                if (glm::dot(center - point, normal) < -radius) {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
     private:
         const std::array<Plane, 6> planes;
 
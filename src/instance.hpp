@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cmath>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace rasterizer {
+    /*
+     * A placement of a Mesh in the scene.
+     * Many instances can share the same Mesh and Surface, they only own their transformation.
+     */
+    struct Instance {
+        // Indices into Scene.meshes and Scene.surfaces
+        std::size_t mesh;
+        std::size_t surface;
+
+        // Radians, applied around X, then Y, then Z, before scale and translation
+        glm::vec3 rotation{0.0f};
+        glm::vec3 scale{1.0f};
+        glm::vec3 translation{0.0f};
+    };
+
+    /*
+     * Computes view * model for every instance, where model = scaleTranslate * rotationZ * rotationY * rotationX.
+     * The product of the scale/translation and the 3 rotation matrices is expanded in closed form,
+     * which avoids the 3 matrix products per instance and keeps the loop free of temporaries.
+     */
+    inline void computeModelViewTransformations(const std::vector<Instance>& instances, const glm::mat4& view,
+                                                std::vector<glm::mat4>& modelViews) {
+        modelViews.resize(instances.size());
+
+        for (std::size_t i = 0; i < instances.size(); ++i) {
+            const auto& rotation = instances[i].rotation;
+            const auto& scale = instances[i].scale;
+            const auto& translation = instances[i].translation;
+
+            const glm::float32_t cosX = std::cos(rotation.x);
+            const glm::float32_t sinX = std::sin(rotation.x);
+            const glm::float32_t cosY = std::cos(rotation.y);
+            const glm::float32_t sinY = std::sin(rotation.y);
+            const glm::float32_t cosZ = std::cos(rotation.z);
+            const glm::float32_t sinZ = std::sin(rotation.z);
+
+            // Columns of scaleTranslate * rotationZ * rotationY * rotationX
+            const glm::mat4 model{
+                scale.x * cosZ * cosY,
+                scale.y * sinZ * cosY,
+                scale.z * -sinY,
+                0.0f,
+
+                scale.x * (cosZ * sinY * sinX - sinZ * cosX),
+                scale.y * (sinZ * sinY * sinX + cosZ * cosX),
+                scale.z * cosY * sinX,
+                0.0f,
+
+                scale.x * (cosZ * sinY * cosX + sinZ * sinX),
+                scale.y * (sinZ * sinY * cosX - cosZ * sinX),
+                scale.z * cosY * cosX,
+                0.0f,
+
+                translation.x, translation.y, translation.z, 1.0f
+            };
+
+            modelViews[i] = view * model;
+        }
+    }
+
+    /*
+     * Computes the matrix that takes Model-space normals to View-space for every Model-View transformation.
+     * The cofactor matrix is the inverse transpose scaled by the determinant, so it stays correct under non-uniform
+     * scale and, like the cross product of the transformed edges, flips normals when the transformation mirrors.
+     */
+    inline void computeNormalTransformations(const std::vector<glm::mat4>& modelViews,
+                                             std::vector<glm::mat3>& normals) {
+        normals.resize(modelViews.size());
+
+        for (std::size_t i = 0; i < modelViews.size(); ++i) {
+            const glm::vec3 x{modelViews[i][0]};
+            const glm::vec3 y{modelViews[i][1]};
+            const glm::vec3 z{modelViews[i][2]};
+
+            normals[i] = glm::mat3{glm::cross(y, z), glm::cross(z, x), glm::cross(x, y)};
+        }
+    }
+}
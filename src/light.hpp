@@ -17,7 +17,7 @@ namespace rasterizer {
             const color_t b = (color & 0x0000FF00) * attenuation;
             const color_t a = color & 0x000000FF;
 
-            return r & 0xFF000000 | g & 0x00FF0000 | b & 0x0000FF00 | a & 0x000000FF;
+            return (r & 0xFF000000) | (g & 0x00FF0000) | (b & 0x0000FF00) | (a & 0x000000FF);
         }
     };
 }
@@ -1,8 +1,44 @@
 #define SDL_MAIN_HANDLED
 #include <SDL2/SDL.h>
 
+#include <atomic>
+#include <charconv>
+#include <csignal>
+#include <cstdlib>
+#include <limits>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
 #include "common.hpp"
 #include "app.hpp"
+#include "frame_ring_sink.hpp"
+#include "frame_writer.hpp"
+#include "pacer.hpp"
+
+#ifndef NDEBUG
+// Counted so that Application can check that drawing a frame does not allocate
+void* operator new(const std::size_t size) {
+    if (rasterizer::uncountedAllocationsDepth == 0) {
+        rasterizer::heapAllocationsAmount.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (void* pointer = std::malloc(size == 0 ? 1 : size)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+// Out of line, GCC otherwise pairs the inlined std::free with operator new (-Wmismatched-new-delete)
+[[gnu::noinline]] void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+[[gnu::noinline]] void operator delete(void* pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+#endif
 
 static std::uint64_t previousFrameTime = 0;
 
@@ -17,23 +53,174 @@ void newFrame(void* argument) {
     }
 }
 
+// Whole text as an unsigned integer
+template<typename T>
+static std::optional<T> parseUnsigned(const std::string_view text) {
+    T value = 0;
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (error != std::errc{} || end != text.data() + text.size()) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+static constexpr std::string_view USAGE =
+    "Usage: rasterizer [--memory-budget MB] [--headless [--frames N] [--size WIDTHxHEIGHT]"
+    " [--output DIRECTORY [--format ppm|raw|png] | --shared-memory NAME]]";
+
+struct Options {
+    std::size_t memoryBudgetBytes = rasterizer::ResidencyManager::DEFAULT_BUDGET_BYTES;
+    // Absent when windowed
+    std::optional<rasterizer::HeadlessOptions> headless;
+};
+
+/*
+ * --memory-budget MB bounds the resident mesh and surface data, in both windowed and headless modes.
+ * Headless when run with --headless [--frames N] [--size WIDTHxHEIGHT], frames are then either
+ * written with --output DIRECTORY [--format ppm|raw|png] or shared with another process with --shared-memory NAME
+ */
+static Options parseOptions(const int argc, char* argv[]) {
+    Options options;
+    rasterizer::HeadlessOptions headless;
+    bool isHeadless = false;
+    std::optional<std::string_view> output;
+    std::optional<std::string> sharedMemory;
+    auto format = rasterizer::ImageFormat::PPM;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view argument = argv[i];
+        if (argument == "--headless") {
+            isHeadless = true;
+            continue;
+        }
+
+        // Every other option takes a value
+        if (i + 1 == argc) {
+            throw std::runtime_error(std::format("Missing value for {}\n{}", argument, USAGE));
+        }
+        const std::string_view value = argv[++i];
+        if (argument == "--memory-budget") {
+            constexpr std::size_t MEGABYTE = 1024 * 1024;
+            const auto megabytes = parseUnsigned<std::size_t>(value);
+            if (!megabytes || *megabytes == 0 || *megabytes > std::numeric_limits<std::size_t>::max() / MEGABYTE) {
+                throw std::runtime_error(std::format("Invalid --memory-budget, expected megabytes: {}", value));
+            }
+            options.memoryBudgetBytes = *megabytes * MEGABYTE;
+        } else if (argument == "--frames") {
+            const auto framesAmount = parseUnsigned<std::uint64_t>(value);
+            if (!framesAmount) {
+                throw std::runtime_error(std::format("Invalid --frames, expected a frame count: {}", value));
+            }
+            headless.framesAmount = *framesAmount;
+        } else if (argument == "--size") {
+            const auto separator = value.find('x');
+            const auto width = parseUnsigned<std::uint32_t>(value.substr(0, separator));
+            const auto height = separator == std::string_view::npos
+                                    ? std::nullopt
+                                    : parseUnsigned<std::uint32_t>(value.substr(separator + 1));
+            if (!width || !height || *width == 0 || *height == 0) {
+                throw std::runtime_error(std::format("Invalid --size, expected WIDTHxHEIGHT: {}", value));
+            }
+            headless.width = *width;
+            headless.height = *height;
+        } else if (argument == "--output") {
+            output = value;
+        } else if (argument == "--shared-memory") {
+            // POSIX shared memory object names start with a slash
+            sharedMemory = value.starts_with('/') ? std::string(value) : "/" + std::string(value);
+        } else if (argument == "--format") {
+            if (value == "ppm") {
+                format = rasterizer::ImageFormat::PPM;
+            } else if (value == "raw") {
+                format = rasterizer::ImageFormat::RAW;
+            } else if (value == "png") {
+                format = rasterizer::ImageFormat::PNG;
+            } else {
+                throw std::runtime_error(std::format("Invalid --format, expected ppm, raw or png: {}", value));
+            }
+        } else {
+            throw std::runtime_error(std::format("Unknown option: {}\n{}", argument, USAGE));
+        }
+    }
+
+    if (!isHeadless) {
+        return options;
+    }
+    if (output && sharedMemory) {
+        throw std::runtime_error("--output and --shared-memory are exclusive, frames go to a single sink");
+    }
+    if (output) {
+        headless.sink = std::make_unique<rasterizer::FrameWriter>(*output, format);
+    } else if (sharedMemory) {
+        headless.sink = std::make_unique<rasterizer::FrameRingSink>(*sharedMemory, headless.width, headless.height);
+    }
+    options.headless = std::move(headless);
+
+    return options;
+}
+
+// Set by SIGINT and SIGTERM, a headless run then stops after the current frame so its frame sink is destroyed
+static volatile std::sig_atomic_t isInterrupted = 0;
+static std::atomic<rasterizer::FrameSink*> interruptedSink = nullptr;
+static_assert(std::atomic<rasterizer::FrameSink*>::is_always_lock_free, "Read from a signal handler");
+
+extern "C" void interrupt(const int) {
+    isInterrupted = 1;
+    // A frame sink can be blocked waiting for another process
+    if (rasterizer::FrameSink* sink = interruptedSink.load()) {
+        sink->interrupt();
+    }
+}
+
+// Forwards SIGINT and SIGTERM to the frame sink of a headless run, for as long as the scope lives
+class InterruptScope {
+public:
+    explicit InterruptScope(rasterizer::FrameSink& sink) {
+        interruptedSink = &sink;
+        std::signal(SIGINT, interrupt);
+        std::signal(SIGTERM, interrupt);
+    }
+
+    ~InterruptScope() {
+        std::signal(SIGINT, SIG_DFL);
+        std::signal(SIGTERM, SIG_DFL);
+        interruptedSink = nullptr;
+    }
+
+    InterruptScope(const InterruptScope&) = delete;
+    InterruptScope& operator=(const InterruptScope&) = delete;
+};
+
 int main(int argc, char* argv[]) try {
     constexpr std::string_view title = "Hello Rasterizer";
     constexpr std::uint32_t FPS = 120;
-    constexpr std::uint64_t FRAME_TARGET_TIME = 1000 / FPS;
 
-    rasterizer::Application app(title);
+    auto options = parseOptions(argc, argv);
+
+#ifndef __EMSCRIPTEN__
+    if (options.headless) {
+        rasterizer::FrameSink& sink = *options.headless->sink;
+        rasterizer::Application app(std::move(*options.headless), options.memoryBudgetBytes);
+        // Runs without a frame amount end on a signal, destroying the frame sink removes a shared memory ring
+        const InterruptScope interruptScope(sink);
+
+        // Uncapped, throughput is only limited by rendering and the frame sink
+        while (app.isRunning && isInterrupted == 0) {
+            newFrame(&app);
+        }
+
+        return EXIT_SUCCESS;
+    }
+#endif
+
+    rasterizer::Application app(title, options.memoryBudgetBytes);
 
 #ifdef __EMSCRIPTEN__
     emscripten_set_main_loop_arg(newFrame, &app, 0, true);
 #else
+    rasterizer::FramePacer pacer(FPS);
     while (app.isRunning) {
-        // Only delay execution if we are running too fast
-        if (const std::uint64_t timeToWait = FRAME_TARGET_TIME - (SDL_GetTicks() - previousFrameTime);
-            0 < timeToWait && timeToWait <= FRAME_TARGET_TIME) {
-            SDL_Delay(timeToWait);
-        }
-
+        pacer.wait();
         newFrame(&app);
     }
 #endif
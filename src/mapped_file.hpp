@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define RASTERIZER_HAS_MMAP 1
+#else
+#define RASTERIZER_HAS_MMAP 0
+#endif
+
+namespace rasterizer {
+    enum class FileAccess : std::uint8_t {
+        // Scanned front to back once, e.g. parsed
+        SEQUENTIAL,
+        // Used as a whole for as long as it is mapped, e.g. asset files
+        WHOLE
+    };
+
+    /*
+     * Read-only view of a whole file.
+     * Memory-mapped where available, otherwise read into a buffer up front.
+     */
+    class MappedFile {
+    public:
+        explicit MappedFile(const std::filesystem::path& path,
+                            [[maybe_unused]] const FileAccess access = FileAccess::SEQUENTIAL) {
+#if RASTERIZER_HAS_MMAP
+            const int descriptor = ::open(path.c_str(), O_RDONLY);
+            if (descriptor < 0) {
+                throw std::runtime_error("Failed to open file: " + path.string());
+            }
+
+            struct stat status{};
+            if (::fstat(descriptor, &status) != 0) {
+                ::close(descriptor);
+                throw std::runtime_error("Failed to stat file: " + path.string());
+            }
+            size = static_cast<std::size_t>(status.st_size);
+
+            if (size > 0) {
+                void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+                if (mapping == MAP_FAILED) {
+                    ::close(descriptor);
+                    throw std::runtime_error("Failed to map file: " + path.string());
+                }
+                // Whole files are read ahead right away, without waiting for the first page faults
+                ::madvise(mapping, size, access == FileAccess::SEQUENTIAL ? MADV_SEQUENTIAL : MADV_WILLNEED);
+                bytes = static_cast<const std::byte*>(mapping);
+            }
+            // The mapping outlives the descriptor
+            ::close(descriptor);
+#else
+            std::ifstream file(path, std::ios::binary | std::ios::ate);
+            if (!file.is_open()) {
+                throw std::runtime_error("Failed to open file: " + path.string());
+            }
+            size = static_cast<std::size_t>(file.tellg());
+            buffer.resize(size);
+            file.seekg(0);
+            file.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(size));
+            bytes = buffer.data();
+#endif
+        }
+
+        ~MappedFile() {
+#if RASTERIZER_HAS_MMAP
+            if (bytes != nullptr) {
+                ::munmap(const_cast<std::byte*>(bytes), size);
+                bytes = nullptr;
+            }
+#endif
+        }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        const std::byte* data() const {
+            return bytes;
+        }
+
+        std::size_t bytesAmount() const {
+            return size;
+        }
+
+        std::string_view text() const {
+            return {reinterpret_cast<const char*>(bytes), size};
+        }
+
+    private:
+        const std::byte* bytes = nullptr;
+        std::size_t size = 0;
+#if !RASTERIZER_HAS_MMAP
+        std::vector<std::byte> buffer;
+#endif
+    };
+}
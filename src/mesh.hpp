@@ -1,10 +1,15 @@
 #pragma once
 
+#include <cstddef>
+#include <memory>
+#include <span>
 #include <vector>
 
 #include <glm/glm.hpp>
 
-#include "texture.hpp"
+#include "color.hpp"
+#include "meshlet.hpp"
+#include "vertex.hpp"
 
 namespace rasterizer {
     struct TriangleFace {
@@ -12,89 +17,87 @@ namespace rasterizer {
         const std::array<glm::vec2, 3> uvs;
     };
 
+    // A level of detail, every level indexes the same Mesh vertices
+    struct MeshLod {
+        // 3 indices into Mesh.vertices per face
+        const IndexSpan indices;
+        // Per face Model-space unit normal (zero if degenerate) and unlit base color
+        const std::span<const glm::vec3> faceNormals;
+        const std::span<const color_t> faceColors;
+        const MeshletView meshlets;
+        // Maximum distance to the full detail surface, in Model-space units
+        const glm::float32_t error;
+
+        std::size_t facesAmount() const {
+            return indices.size() / 3;
+        }
+    };
+
     /*
+     * Immutable geometry, shared by every Instance that references it.
      * The mesh faces are assumed to be:
      *  - Clockwise
      *  - Triangular
      */
     struct Mesh {
-        const std::vector<glm::vec3> vertices;
-        const std::vector<glm::vec2> uvs;
-        const std::vector<std::uint32_t> faceIndices;
-        const std::vector<std::uint32_t> uvIndices;
+        // Projected error (in pixels) below which a coarser level of detail is indistinguishable
+        static constexpr glm::float32_t LOD_PIXEL_ERROR = 1.0f;
 
-        glm::vec3 rotation{0.0f};
-        glm::vec3 scale{1.0f};
-        glm::vec3 translation{0.0f};
+        // Serialized mesh every array below points into (see mesh_file.hpp),
+        // kept alive by storage: either the mapped mesh file or the buffer the mesh was built in
+        const std::shared_ptr<const void> storage;
+        const std::span<const std::byte> image;
 
-        std::size_t facesAmount() const {
-            return faceIndices.size() / 3;
+        // Welded (position, uv) pairs, in one of two formats
+        const VertexFormat vertexFormat;
+        // FLOAT32
+        const std::span<const Vertex> vertices;
+        // QUANTIZED16
+        const std::span<const QuantizedVertex> quantizedVertices;
+        const VertexQuantization quantization;
+        // Ordered from full detail to coarsest
+        const std::vector<MeshLod> lods;
+
+        // Model-space bounding sphere
+        const glm::vec3 center;
+        const glm::float32_t radius;
+
+        std::size_t verticesAmount() const {
+            return vertexFormat == VertexFormat::QUANTIZED16 ? quantizedVertices.size() : vertices.size();
         }
 
-        // TODO: Allow for per-vertex optional uv texturing, right now if there is a mix this will assign incorrectly
-        TriangleFace operator[](const std::size_t index) const {
-            const size_t fi = 3 * index;
+        Vertex vertex(const std::size_t index) const {
+            return vertexFormat == VertexFormat::QUANTIZED16 ? quantization.dequantize(quantizedVertices[index])
+                                                             : vertices[index];
+        }
+
+        std::size_t facesAmount(const std::size_t lod = 0) const {
+            return lods[lod].facesAmount();
+        }
 
-            const auto v0 = faceIndices[fi];
-            const auto v1 = faceIndices[fi + 1];
-            const auto v2 = faceIndices[fi + 2];
+        TriangleFace face(const std::size_t lod, const std::size_t index) const {
+            const size_t fi = 3 * index;
+            const auto& indices = lods[lod].indices;
 
-            const auto vt0 = uvIndices[fi];
-            const auto vt1 = uvIndices[fi + 1];
-            const auto vt2 = uvIndices[fi + 2];
+            const auto v0 = vertex(indices[fi]);
+            const auto v1 = vertex(indices[fi + 1]);
+            const auto v2 = vertex(indices[fi + 2]);
 
             return {
-                .vertices = {
-                    vertices[v0],
-                    vertices[v1],
-                    vertices[v2]
-                },
-                .uvs = {
-                    uvs[vt0],
-                    uvs[vt1],
-                    uvs[vt2],
-                }
+                .vertices = {v0.position, v1.position, v2.position},
+                .uvs = {v0.uv, v1.uv, v2.uv}
             };
         }
 
-        glm::mat4 modelTransformation() const {
-            const glm::float32_t cosX = std::cos(rotation.x);
-            const glm::float32_t sinX = std::sin(rotation.x);
-            const glm::float32_t cosY = std::cos(rotation.y);
-            const glm::float32_t sinY = std::sin(rotation.y);
-            const glm::float32_t cosZ = std::cos(rotation.z);
-            const glm::float32_t sinZ = std::sin(rotation.z);
-
-            // The GLM memory layout is row based
-            // We need to transpose the elements compared to the original rotation matrices
-            const auto rotationX = glm::mat4{
-                1.0f, 0.0f, 0.0f, 0.0f,
-                0.0f, cosX, sinX, 0.0f,
-                0.0f, -sinX, cosX, 0.0f,
-                0.0f, 0.0f, 0.0f, 1.0f,
-            };
-            const auto rotationY = glm::mat4{
-                cosY, 0.0f, -sinY, 0.0f,
-                0.0f, 1.0f, 0.0f, 0.0f,
-                sinY, 0.0f, cosY, 0.0f,
-                0.0f, 0.0f, 0.0f, 1.0f
-            };
-            const auto rotationZ = glm::mat4{
-                cosZ, sinZ, 0.0f, 0.0f,
-                -sinZ, cosZ, 0.0f, 0.0f,
-                0.0f, 0.0f, 1.0f, 0.0f,
-                0.0f, 0.0f, 0.0f, 1.0f,
-            };
-            const auto scaleTranslate = glm::mat4{
-                scale.x, 0.0f, 0.0f, 0.0f,
-                0.0f, scale.y, 0.0f, 0.0f,
-                0.0f, 0.0f, scale.z, 0.0f,
-                translation.x, translation.y, translation.z, 1.0f
-            };
+        // pixelsPerUnit: screen-space size of one Model-space unit at the mesh distance
+        std::size_t selectLod(const glm::float32_t pixelsPerUnit) const {
+            // Coarsest level whose error is not noticeable on screen
+            std::size_t lod = 0;
+            while (lod + 1 < lods.size() && lods[lod + 1].error * pixelsPerUnit <= LOD_PIXEL_ERROR) {
+                ++lod;
+            }
 
-            // First rotate, then translate
-            // Scale is a diagonal matrix => is product commutative => can be performed in any order
-            return scaleTranslate * rotationZ * rotationY * rotationX;
+            return lod;
         }
     };
 }
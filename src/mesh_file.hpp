@@ -0,0 +1,347 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "asset_file.hpp"
+#include "color.hpp"
+#include "mapped_file.hpp"
+#include "mesh.hpp"
+#include "meshlet.hpp"
+#include "vertex.hpp"
+
+namespace rasterizer {
+    static constexpr std::string_view MESH_FILE_EXTENSION = ".rmesh";
+
+    // Range of elements of a MeshFile section, offset in bytes from the start of the file
+    struct MeshFileSection {
+        std::uint64_t offset;
+        std::uint64_t amount;
+    };
+
+    struct MeshFileLod {
+        MeshFileSection indices;
+        MeshFileSection faceNormals;
+        MeshFileSection faceColors;
+        MeshFileSection meshlets;
+        MeshFileSection meshletVertices;
+        MeshFileSection meshletTriangles;
+        glm::float32_t error;
+        std::uint32_t reserved;
+    };
+
+    /*
+     * Compact binary mesh: MeshFileHeader, MeshFileLod[lodsAmount], then every array of the Mesh as is.
+     * Sections start on a cache line, so once the file is mapped the Mesh spans point straight into it
+     * and loading costs a single pass over the indices to validate them, instead of parsing.
+     * Arrays are stored in native byte order and layout, files are rebuilt rather than converted.
+     */
+    struct MeshFileHeader {
+        static constexpr std::array<char, 8> MAGIC = {'R', 'M', 'E', 'S', 'H', '\0', '\0', '\0'};
+        // Bump on any change to the layout of the header or of the stored types
+        static constexpr std::uint32_t VERSION = 2;
+        static constexpr std::uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+        std::array<char, 8> magic;
+        std::uint32_t version;
+        std::uint32_t byteOrder;
+
+        AssetSource source;
+
+        glm::vec3 center;
+        glm::float32_t radius;
+
+        MeshFileSection vertices;
+        std::uint32_t lodsAmount;
+        VertexFormat vertexFormat;
+        // Of every index section, 2 or 4
+        std::uint32_t indexBytes;
+        std::uint32_t reserved;
+        VertexQuantization quantization;
+    };
+
+    static_assert(std::is_trivially_copyable_v<MeshFileHeader> && std::is_trivially_copyable_v<MeshFileLod>);
+    static_assert(sizeof(MeshFileHeader) == 128 && sizeof(MeshFileLod) == 104);
+    static_assert(sizeof(Vertex) == 20 && sizeof(QuantizedVertex) == 10 && sizeof(VertexQuantization) == 40);
+    static_assert(sizeof(Meshlet) == 48 && sizeof(color_t) == 4);
+
+    // A level of detail being built, owning its arrays
+    struct MeshLodBuffers {
+        std::vector<std::uint32_t> indices;
+        std::vector<glm::vec3> faceNormals;
+        std::vector<color_t> faceColors;
+        MeshletSet meshlets;
+        glm::float32_t error;
+    };
+
+    // A mesh being built, owning its arrays
+    struct MeshBuffers {
+        VertexFormat vertexFormat;
+        // FLOAT32
+        std::vector<Vertex> vertices;
+        // QUANTIZED16
+        std::vector<QuantizedVertex> quantizedVertices;
+        VertexQuantization quantization;
+
+        std::vector<MeshLodBuffers> lods;
+        glm::vec3 center;
+        glm::float32_t radius;
+    };
+
+    inline std::vector<std::byte> serializeMesh(const AssetSource& source, const MeshBuffers& mesh) {
+        const auto& lods = mesh.lods;
+        const std::size_t verticesAmount = mesh.vertexFormat == VertexFormat::QUANTIZED16
+                                               ? mesh.quantizedVertices.size()
+                                               : mesh.vertices.size();
+        const bool hasShortIndices = mesh.vertexFormat == VertexFormat::QUANTIZED16
+                                     && verticesAmount <= std::size_t{std::numeric_limits<std::uint16_t>::max()} + 1;
+        const std::size_t indexBytes = hasShortIndices ? sizeof(std::uint16_t) : sizeof(std::uint32_t);
+
+        // Lay out every section first, then copy
+        std::size_t end = sizeof(MeshFileHeader) + lods.size() * sizeof(MeshFileLod);
+        const auto reserveBytes = [&](const std::size_t amount, const std::size_t elementBytes) {
+            const std::size_t offset = alignAssetSection(end);
+            end = offset + amount * elementBytes;
+            return MeshFileSection{.offset = offset, .amount = amount};
+        };
+        const auto reserve = [&]<typename T>(const std::vector<T>& elements) {
+            return reserveBytes(elements.size(), sizeof(T));
+        };
+        const auto reserveIndices = [&](const std::vector<std::uint32_t>& indices) {
+            return reserveBytes(indices.size(), indexBytes);
+        };
+
+        MeshFileHeader header{
+            .magic = MeshFileHeader::MAGIC,
+            .version = MeshFileHeader::VERSION,
+            .byteOrder = MeshFileHeader::BYTE_ORDER_MARK,
+            .source = source,
+            .center = mesh.center, .radius = mesh.radius,
+            .vertices = mesh.vertexFormat == VertexFormat::QUANTIZED16 ? reserve(mesh.quantizedVertices)
+                                                                       : reserve(mesh.vertices),
+            .lodsAmount = static_cast<std::uint32_t>(lods.size()),
+            .vertexFormat = mesh.vertexFormat,
+            .indexBytes = static_cast<std::uint32_t>(indexBytes),
+            .reserved = 0,
+            .quantization = mesh.quantization
+        };
+        std::vector<MeshFileLod> lodHeaders;
+        lodHeaders.reserve(lods.size());
+        for (const auto& lod : lods) {
+            lodHeaders.emplace_back(MeshFileLod{
+                .indices = reserveIndices(lod.indices),
+                .faceNormals = reserve(lod.faceNormals),
+                .faceColors = reserve(lod.faceColors),
+                .meshlets = reserve(lod.meshlets.meshlets),
+                .meshletVertices = reserveIndices(lod.meshlets.vertices),
+                .meshletTriangles = reserve(lod.meshlets.triangles),
+                .error = lod.error,
+                .reserved = 0
+            });
+        }
+
+        // Zero-initialized, padding included
+        std::vector<std::byte> image(end);
+        const auto copy = [&]<typename T>(const MeshFileSection& section, const std::vector<T>& elements) {
+            if (!elements.empty()) {
+                std::memcpy(image.data() + section.offset, elements.data(), elements.size() * sizeof(T));
+            }
+        };
+        const auto copyIndices = [&](const MeshFileSection& section, const std::vector<std::uint32_t>& indices) {
+            if (!hasShortIndices) {
+                copy(section, indices);
+                return;
+            }
+            for (std::size_t i = 0; i < indices.size(); ++i) {
+                const auto index = static_cast<std::uint16_t>(indices[i]);
+                std::memcpy(image.data() + section.offset + i * sizeof(index), &index, sizeof(index));
+            }
+        };
+
+        std::memcpy(image.data(), &header, sizeof(header));
+        std::memcpy(image.data() + sizeof(header), lodHeaders.data(), lodHeaders.size() * sizeof(MeshFileLod));
+        if (mesh.vertexFormat == VertexFormat::QUANTIZED16) {
+            copy(header.vertices, mesh.quantizedVertices);
+        } else {
+            copy(header.vertices, mesh.vertices);
+        }
+        for (std::size_t lod = 0; lod < lods.size(); ++lod) {
+            copyIndices(lodHeaders[lod].indices, lods[lod].indices);
+            copy(lodHeaders[lod].faceNormals, lods[lod].faceNormals);
+            copy(lodHeaders[lod].faceColors, lods[lod].faceColors);
+            copy(lodHeaders[lod].meshlets, lods[lod].meshlets.meshlets);
+            copyIndices(lodHeaders[lod].meshletVertices, lods[lod].meshlets.vertices);
+            copy(lodHeaders[lod].meshletTriangles, lods[lod].meshlets.triangles);
+        }
+
+        return image;
+    }
+
+    namespace {
+        template<typename T>
+        std::optional<std::span<const T>> viewSection(const std::span<const std::byte> image,
+                                                      const rasterizer::MeshFileSection& section) {
+            if (section.offset % alignof(T) != 0 || section.offset > image.size()
+                || section.amount > (image.size() - section.offset) / sizeof(T)) {
+                return std::nullopt;
+            }
+
+            return std::span(reinterpret_cast<const T*>(image.data() + section.offset), section.amount);
+        }
+
+        std::optional<rasterizer::IndexSpan> viewIndexSection(const std::span<const std::byte> image,
+                                                              const rasterizer::MeshFileSection& section,
+                                                              const std::uint32_t indexBytes) {
+            if (indexBytes == sizeof(std::uint16_t)) {
+                return viewSection<std::uint16_t>(image, section);
+            }
+            return viewSection<std::uint32_t>(image, section);
+        }
+
+        bool areIndicesBelow(const rasterizer::IndexSpan& indices, const std::size_t limit) {
+            for (std::size_t i = 0; i < indices.size(); ++i) {
+                if (indices[i] >= limit) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // Indices address existing vertices, and meshlets ranges of existing faces and vertices
+        bool isLodValid(const rasterizer::MeshLod& lod, const std::size_t verticesAmount) {
+            const auto& [meshlets, meshletVertices, meshletTriangles] = lod.meshlets;
+            if (!areIndicesBelow(lod.indices, verticesAmount) || !areIndicesBelow(meshletVertices, verticesAmount)) {
+                return false;
+            }
+
+            for (const auto& meshlet : meshlets) {
+                if (meshlet.verticesAmount > rasterizer::Meshlet::MAX_VERTICES
+                    || meshlet.facesAmount > rasterizer::Meshlet::MAX_FACES
+                    || std::uint64_t{meshlet.vertexOffset} + meshlet.verticesAmount > meshletVertices.size()
+                    || std::uint64_t{meshlet.faceOffset} + meshlet.facesAmount > lod.facesAmount()) {
+                    return false;
+                }
+                for (std::size_t corner = 3 * std::size_t{meshlet.faceOffset};
+                     corner < 3 * (std::size_t{meshlet.faceOffset} + meshlet.facesAmount); ++corner) {
+                    if (meshletTriangles[corner] >= meshlet.verticesAmount) {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+    }
+
+    /*
+     * Builds a Mesh whose arrays point into image, storage must keep image alive.
+     * The header, section bounds and every index are validated, nullopt if any is out of range.
+     */
+    inline std::optional<Mesh> viewMesh(std::shared_ptr<const void> storage, const std::span<const std::byte> image) {
+        // Mappings are page aligned and heap buffers are aligned for any fundamental type
+        if (image.size() < sizeof(MeshFileHeader)
+            || reinterpret_cast<std::uintptr_t>(image.data()) % alignof(MeshFileHeader) != 0) {
+            return std::nullopt;
+        }
+        const auto& header = *reinterpret_cast<const MeshFileHeader*>(image.data());
+        if (header.magic != MeshFileHeader::MAGIC || header.version != MeshFileHeader::VERSION
+            || header.byteOrder != MeshFileHeader::BYTE_ORDER_MARK || header.lodsAmount == 0
+            || header.lodsAmount > (image.size() - sizeof(MeshFileHeader)) / sizeof(MeshFileLod)
+            || (header.vertexFormat != VertexFormat::FLOAT32 && header.vertexFormat != VertexFormat::QUANTIZED16)
+            || (header.indexBytes != sizeof(std::uint16_t) && header.indexBytes != sizeof(std::uint32_t))) {
+            return std::nullopt;
+        }
+
+        const bool isQuantized = header.vertexFormat == VertexFormat::QUANTIZED16;
+        const auto vertices = isQuantized ? std::span<const Vertex>{}
+                                          : viewSection<Vertex>(image, header.vertices);
+        const auto quantizedVertices = isQuantized ? viewSection<QuantizedVertex>(image, header.vertices)
+                                                   : std::span<const QuantizedVertex>{};
+        if (!vertices || !quantizedVertices) {
+            return std::nullopt;
+        }
+
+        const auto* lodHeaders = reinterpret_cast<const MeshFileLod*>(image.data() + sizeof(MeshFileHeader));
+        std::vector<MeshLod> lods;
+        lods.reserve(header.lodsAmount);
+        for (std::uint32_t lod = 0; lod < header.lodsAmount; ++lod) {
+            const auto& lodHeader = lodHeaders[lod];
+            const auto indices = viewIndexSection(image, lodHeader.indices, header.indexBytes);
+            const auto faceNormals = viewSection<glm::vec3>(image, lodHeader.faceNormals);
+            const auto faceColors = viewSection<color_t>(image, lodHeader.faceColors);
+            const auto meshlets = viewSection<Meshlet>(image, lodHeader.meshlets);
+            const auto meshletVertices = viewIndexSection(image, lodHeader.meshletVertices, header.indexBytes);
+            const auto meshletTriangles = viewSection<std::uint8_t>(image, lodHeader.meshletTriangles);
+            if (!indices || !faceNormals || !faceColors || !meshlets || !meshletVertices || !meshletTriangles
+                || indices->size() != 3 * faceNormals->size() || faceNormals->size() != faceColors->size()
+                || meshletTriangles->size() != indices->size()) {
+                return std::nullopt;
+            }
+
+            lods.emplace_back(MeshLod{
+                .indices = *indices,
+                .faceNormals = *faceNormals, .faceColors = *faceColors,
+                .meshlets = {.meshlets = *meshlets, .vertices = *meshletVertices, .triangles = *meshletTriangles},
+                .error = lodHeader.error
+            });
+            if (!isLodValid(lods.back(), header.vertices.amount)) {
+                return std::nullopt;
+            }
+        }
+
+        return Mesh{
+            .storage = std::move(storage), .image = image,
+            .vertexFormat = header.vertexFormat,
+            .vertices = *vertices, .quantizedVertices = *quantizedVertices, .quantization = header.quantization,
+            .lods = std::move(lods),
+            .center = header.center, .radius = header.radius
+        };
+    }
+
+    // Reads only the header of a mesh file, nullopt if it is missing or from another version
+    inline std::optional<MeshFileHeader> readMeshFileHeader(const std::filesystem::path& meshPath) {
+        std::ifstream file(meshPath, std::ios::binary);
+        MeshFileHeader header;
+        if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))
+            || header.magic != MeshFileHeader::MAGIC || header.version != MeshFileHeader::VERSION
+            || header.byteOrder != MeshFileHeader::BYTE_ORDER_MARK) {
+            return std::nullopt;
+        }
+        return header;
+    }
+
+    inline const AssetSource& meshSource(const Mesh& mesh) {
+        return reinterpret_cast<const MeshFileHeader*>(mesh.image.data())->source;
+    }
+
+    // Maps a mesh file, nullopt if it is missing, from another version or malformed
+    inline std::optional<Mesh> readMeshFile(const std::filesystem::path& meshPath) {
+        std::error_code error;
+        if (!std::filesystem::is_regular_file(meshPath, error)) {
+            return std::nullopt;
+        }
+
+        std::shared_ptr<const MappedFile> file;
+        try {
+            file = std::make_shared<const MappedFile>(meshPath, FileAccess::WHOLE);
+        } catch (const std::runtime_error&) {
+            return std::nullopt;
+        }
+
+        const std::span image(file->data(), file->bytesAmount());
+        return viewMesh(std::move(file), image);
+    }
+}
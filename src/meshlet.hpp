@@ -0,0 +1,307 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "optimize.hpp"
+#include "vertex.hpp"
+
+namespace rasterizer {
+    /*
+     * A meshlet is a run of consecutive mesh faces that references a small, bounded set of vertices.
+     * Its bounds are stored in Model-space so that the whole cluster can be rejected
+     * before any of its vertices are transformed.
+     */
+    struct Meshlet {
+        static constexpr std::size_t MAX_VERTICES = 64;
+        static constexpr std::size_t MAX_FACES = 124;
+
+        // Range into MeshletSet.vertices
+        std::uint32_t vertexOffset;
+        std::uint32_t verticesAmount;
+
+        // Range of mesh faces, their corners are stored as local indices in MeshletSet.triangles
+        std::uint32_t faceOffset;
+        std::uint32_t facesAmount;
+
+        // Bounding sphere
+        glm::vec3 center;
+        glm::float32_t radius;
+
+        // Normal cone, every face normal is within acos(sqrt(1 - coneCutoff^2)) of coneAxis
+        // See: https://zeux.io/2023/04/28/triangle-backface-culling/
+        glm::vec3 coneAxis;
+        glm::float32_t coneCutoff;
+    };
+
+    struct MeshletSet {
+        std::vector<Meshlet> meshlets;
+        // Indices into Mesh.vertices, grouped per meshlet
+        std::vector<std::uint32_t> vertices;
+        // 3 local indices per mesh face, relative to the owning meshlet vertexOffset
+        std::vector<std::uint8_t> triangles;
+    };
+
+    // Read-only MeshletSet, as stored in a Mesh
+    struct MeshletView {
+        std::span<const Meshlet> meshlets;
+        IndexSpan vertices;
+        std::span<const std::uint8_t> triangles;
+    };
+
+    namespace {
+        void computeMeshletBounds(Meshlet& meshlet,
+                                  const std::vector<rasterizer::Vertex>& vertices,
+                                  const std::vector<std::uint32_t>& indices,
+                                  const std::vector<std::uint32_t>& meshletVertices) {
+            // Bounding sphere centered at the bounding box center
+            glm::vec3 min{std::numeric_limits<glm::float32_t>::max()};
+            glm::vec3 max{std::numeric_limits<glm::float32_t>::lowest()};
+            for (std::uint32_t v = 0; v < meshlet.verticesAmount; ++v) {
+                const auto& vertex = vertices[meshletVertices[meshlet.vertexOffset + v]].position;
+                min = glm::min(min, vertex);
+                max = glm::max(max, vertex);
+            }
+
+            meshlet.center = (min + max) / 2.0f;
+            meshlet.radius = 0.0f;
+            for (std::uint32_t v = 0; v < meshlet.verticesAmount; ++v) {
+                const auto& vertex = vertices[meshletVertices[meshlet.vertexOffset + v]].position;
+                meshlet.radius = std::max(meshlet.radius, glm::length(vertex - meshlet.center));
+            }
+
+            // Normal cone axis is the average of the face normals
+            // Same winding as computeNormal, degenerate faces do not contribute
+            std::vector<glm::vec3> normals;
+            normals.reserve(meshlet.facesAmount);
+            glm::vec3 axis{0.0f};
+            for (std::uint32_t face = meshlet.faceOffset; face < meshlet.faceOffset + meshlet.facesAmount; ++face) {
+                const auto& v0 = vertices[indices[3 * face]].position;
+                const auto& v1 = vertices[indices[3 * face + 1]].position;
+                const auto& v2 = vertices[indices[3 * face + 2]].position;
+
+                const auto normal = glm::cross(v1 - v0, v2 - v0);
+                const glm::float32_t length = glm::length(normal);
+                if (length == 0.0f) {
+                    continue;
+                }
+
+                normals.emplace_back(normal / length);
+                axis += normals.back();
+            }
+
+            // Default to a cone that can never be entirely backfacing
+            meshlet.coneAxis = {0.0f, 0.0f, 1.0f};
+            meshlet.coneCutoff = 1.0f;
+
+            const glm::float32_t axisLength = glm::length(axis);
+            if (axisLength == 0.0f) {
+                return;
+            }
+
+            glm::float32_t minDot = 1.0f;
+            for (const auto& normal : normals) {
+                minDot = std::min(minDot, glm::dot(normal, axis / axisLength));
+            }
+
+            // Cone is too wide (>= ~84 degrees) for the test to ever succeed
+            if (minDot <= 0.1f) {
+                return;
+            }
+
+            meshlet.coneAxis = axis / axisLength;
+            meshlet.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+        }
+    }
+
+    /*
+     * Greedily grow meshlets over the face adjacency graph.
+     * The next face is the one adding the least new vertices, ties are broken by how well its normal agrees
+     * with the meshlet normals so far, which keeps the normal cones tight.
+     * A new meshlet is started whenever no adjacent face fits within the vertex or face limits.
+     *
+     * Adjacency is established through positionIndices, so that growth is not stopped by uv seams.
+     * Faces are reordered in place so that every meshlet covers a contiguous range of faces.
+     */
+    inline MeshletSet buildMeshlets(const std::vector<Vertex>& vertices,
+                                    const std::vector<std::uint32_t>& positionIndices,
+                                    std::vector<std::uint32_t>& indices) {
+        static constexpr std::uint8_t unused = std::numeric_limits<std::uint8_t>::max();
+        static_assert(Meshlet::MAX_VERTICES < unused);
+        // Faces deviating more than ~66 degrees from the meshlet average normal start a new meshlet
+        static constexpr glm::float32_t MIN_CONE_AGREEMENT = 0.4f;
+
+        const std::size_t facesAmount = indices.size() / 3;
+
+        // Position -> adjacent faces, in compressed form
+        const std::size_t positionsAmount = positionIndices.empty()
+                                                ? 0
+                                                : *std::ranges::max_element(positionIndices) + 1;
+        std::vector<std::uint32_t> adjacencyOffsets(positionsAmount + 1, 0);
+        for (const auto vertex : indices) {
+            adjacencyOffsets[positionIndices[vertex] + 1]++;
+        }
+        for (std::size_t p = 0; p < positionsAmount; ++p) {
+            adjacencyOffsets[p + 1] += adjacencyOffsets[p];
+        }
+        std::vector<std::uint32_t> adjacentFaces(indices.size());
+        {
+            auto cursor = adjacencyOffsets;
+            for (std::size_t i = 0; i < indices.size(); ++i) {
+                adjacentFaces[cursor[positionIndices[indices[i]]]++] = static_cast<std::uint32_t>(i / 3);
+            }
+        }
+
+        // Unit face normals, degenerate faces get a zero normal
+        std::vector<glm::vec3> faceNormals(facesAmount);
+        for (std::size_t face = 0; face < facesAmount; ++face) {
+            const auto& v0 = vertices[indices[3 * face]].position;
+            const auto& v1 = vertices[indices[3 * face + 1]].position;
+            const auto& v2 = vertices[indices[3 * face + 2]].position;
+            const auto normal = glm::cross(v1 - v0, v2 - v0);
+            const glm::float32_t length = glm::length(normal);
+            faceNormals[face] = length > 0.0f ? normal / length : glm::vec3{0.0f};
+        }
+
+        MeshletSet set;
+        set.triangles.reserve(indices.size());
+
+        std::vector<std::uint32_t> faceOrder;
+        faceOrder.reserve(facesAmount);
+        std::vector<bool> isFaceEmitted(facesAmount, false);
+
+        // Vertex -> local index within the meshlet currently being built
+        std::vector<std::uint8_t> localIndices(vertices.size(), unused);
+        Meshlet current{};
+        glm::vec3 currentNormal{0.0f};
+
+        const auto newVerticesAmount = [&](const std::uint32_t face) {
+            const std::uint32_t* corners = &indices[3 * face];
+            return static_cast<std::uint32_t>(localIndices[corners[0]] == unused) +
+                   (localIndices[corners[1]] == unused && corners[1] != corners[0]) +
+                   (localIndices[corners[2]] == unused && corners[2] != corners[0] && corners[2] != corners[1]);
+        };
+
+        const auto fits = [&](const std::uint32_t face) {
+            return current.verticesAmount + newVerticesAmount(face) <= Meshlet::MAX_VERTICES &&
+                   current.facesAmount + 1 <= Meshlet::MAX_FACES;
+        };
+
+        const auto emit = [&](const std::uint32_t face) {
+            const std::uint32_t* corners = &indices[3 * face];
+            for (std::size_t c = 0; c < 3; ++c) {
+                if (localIndices[corners[c]] == unused) {
+                    localIndices[corners[c]] = static_cast<std::uint8_t>(current.verticesAmount++);
+                    set.vertices.emplace_back(corners[c]);
+                }
+                set.triangles.emplace_back(localIndices[corners[c]]);
+            }
+            current.facesAmount++;
+            currentNormal += faceNormals[face];
+            isFaceEmitted[face] = true;
+            faceOrder.emplace_back(face);
+        };
+
+        const auto flush = [&] {
+            for (std::uint32_t v = 0; v < current.verticesAmount; ++v) {
+                localIndices[set.vertices[current.vertexOffset + v]] = unused;
+            }
+            set.meshlets.emplace_back(current);
+
+            const std::uint32_t faceOffset = current.faceOffset + current.facesAmount;
+            current = Meshlet{};
+            current.vertexOffset = static_cast<std::uint32_t>(set.vertices.size());
+            current.faceOffset = faceOffset;
+            currentNormal = glm::vec3{0.0f};
+        };
+
+        std::size_t seed = 0;
+        while (faceOrder.size() < facesAmount) {
+            // Pick the best face adjacent to the meshlet vertices
+            std::uint32_t bestFace = std::numeric_limits<std::uint32_t>::max();
+            std::uint32_t bestNewVertices = std::numeric_limits<std::uint32_t>::max();
+            glm::float32_t bestAgreement = std::numeric_limits<glm::float32_t>::lowest();
+
+            const glm::float32_t currentNormalLength = glm::length(currentNormal);
+            const glm::vec3 currentAxis = currentNormalLength > 0.0f
+                                              ? currentNormal / currentNormalLength
+                                              : glm::vec3{0.0f};
+
+            for (std::uint32_t v = 0; v < current.verticesAmount; ++v) {
+                const auto position = positionIndices[set.vertices[current.vertexOffset + v]];
+                for (auto a = adjacencyOffsets[position]; a < adjacencyOffsets[position + 1]; ++a) {
+                    const auto face = adjacentFaces[a];
+                    if (isFaceEmitted[face] || !fits(face)) {
+                        continue;
+                    }
+
+                    // Keep the normal cone narrow enough to be useful for culling
+                    const auto agreement = glm::dot(faceNormals[face], currentAxis);
+                    if (agreement < MIN_CONE_AGREEMENT) {
+                        continue;
+                    }
+
+                    const auto newVertices = newVerticesAmount(face);
+                    if (newVertices < bestNewVertices ||
+                        (newVertices == bestNewVertices && agreement > bestAgreement)) {
+                        bestFace = face;
+                        bestNewVertices = newVertices;
+                        bestAgreement = agreement;
+                    }
+                }
+            }
+
+            if (bestFace == std::numeric_limits<std::uint32_t>::max()) {
+                // Nothing adjacent fits, start a new meshlet from the next unvisited face
+                if (current.facesAmount > 0) {
+                    flush();
+                }
+                while (isFaceEmitted[seed]) {
+                    seed++;
+                }
+                bestFace = static_cast<std::uint32_t>(seed);
+            }
+
+            emit(bestFace);
+        }
+        if (current.facesAmount > 0) {
+            flush();
+        }
+
+        // Apply the meshlet face order to the mesh
+        std::vector<std::uint32_t> reorderedIndices(indices.size());
+        for (std::size_t i = 0; i < faceOrder.size(); ++i) {
+            for (std::size_t c = 0; c < 3; ++c) {
+                reorderedIndices[3 * i + c] = indices[3 * faceOrder[i] + c];
+            }
+        }
+        indices = std::move(reorderedIndices);
+
+        // Growth order favours few new vertices, not reuse of recent ones, reorder faces within each meshlet
+        std::vector<std::uint32_t> meshletTriangles;
+        for (const auto& meshlet : set.meshlets) {
+            const std::size_t begin = 3 * meshlet.faceOffset, end = begin + 3 * meshlet.facesAmount;
+            meshletTriangles.assign(set.triangles.begin() + begin, set.triangles.begin() + end);
+            rasterizer::optimizeVertexCache(meshletTriangles, meshlet.verticesAmount);
+
+            for (std::size_t i = 0; i < meshletTriangles.size(); ++i) {
+                set.triangles[begin + i] = static_cast<std::uint8_t>(meshletTriangles[i]);
+                indices[begin + i] = set.vertices[meshlet.vertexOffset + meshletTriangles[i]];
+            }
+        }
+
+        for (auto& meshlet : set.meshlets) {
+            computeMeshletBounds(meshlet, vertices, indices, set.vertices);
+        }
+
+        set.meshlets.shrink_to_fit();
+        set.vertices.shrink_to_fit();
+
+        return set;
+    }
+}
@@ -1,95 +1,501 @@
 #pragma once
 
-#include <vector>
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
 #include <filesystem>
-#include <fstream>
-#include <sstream>
 #include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
 
 #include <glm/gtc/type_ptr.hpp>
 
+#include "mapped_file.hpp"
 #include "mesh.hpp"
+#include "mesh_file.hpp"
+#include "meshlet.hpp"
+#include "optimize.hpp"
+#include "simplify.hpp"
+#include "thread_pool.hpp"
+#include "vertex.hpp"
+
+namespace rasterizer {
+    // Vertex cache efficiency of the full detail level, see computeAcmr
+    struct MeshBuildStatistics {
+        glm::float32_t acmrBefore = 0.0f;
+        glm::float32_t acmrAfter = 0.0f;
+    };
+}
 
 namespace {
-    bool parseFace(const std::string& line,
-                   std::vector<std::uint32_t>& faceIndices, std::vector<std::uint32_t>& uvIndices) {
-        // Discard 'f '
-        std::stringstream ss(line.substr(2));
-        std::string faceData;
-
-        // Need to parse 3 triplets of either form:
-        // v1 v2 v3 | v1/vt1 v2/vt2 v3/vt3 | v1/vt1/vn1 v2/vt2/vn2 v3/vt3/vn3 | v1//vn1 v2//vn2 v3//vn3
-        for (std::uint32_t f = 0; ss >> faceData && f < 3; f++) {
-            std::uint32_t v = 0, vt = 0, vn = 0;
-
-            const char* faceData_c = faceData.c_str();
-            // Indices are mapped 1-indexed -> 0-indexed
-            if (std::sscanf(faceData_c, "%u/%u/%u", &v, &vt, &vn) == 3) {
-                faceIndices.emplace_back(v - 1);
-                uvIndices.emplace_back(vt - 1);
-            } else if (std::sscanf(faceData_c, "%u//%u", &v, &vn) == 2) {
-                faceIndices.emplace_back(v - 1);
-            } else if (std::sscanf(faceData_c, "%u/%u", &v, &vt) == 2) {
-                faceIndices.emplace_back(v - 1);
-                uvIndices.emplace_back(vt - 1);
-            } else if (std::sscanf(faceData_c, "%u", &v) == 1) {
-                faceIndices.emplace_back(v - 1);
-            } else {
+    // Contiguous run of whole lines, parsed independently of the other chunks
+    struct ObjChunk {
+        std::string_view text;
+        std::uint32_t firstLine = 0;
+
+        // Counting pass
+        std::uint32_t linesAmount = 0;
+        std::uint32_t verticesAmount = 0;
+        std::uint32_t uvsAmount = 0;
+        std::uint32_t facesAmount = 0;
+
+        // Declared before this chunk, relative (negative) indices are resolved against them
+        std::uint32_t verticesBefore = 0;
+        std::uint32_t uvsBefore = 0;
+        // A v or vt line failed to parse, every later index would be off
+        bool hasMalformedElement = false;
+
+        std::vector<glm::vec3> vertices;
+        std::vector<glm::vec2> uvs;
+        std::vector<std::uint32_t> faceIndices;
+        std::vector<std::uint32_t> uvIndices;
+    };
+
+    // Pops the next line off text, without its line terminator
+    std::string_view nextLine(std::string_view& text) {
+        const auto* newline = static_cast<const char*>(std::memchr(text.data(), '\n', text.size()));
+        const std::size_t length = newline == nullptr ? text.size() : static_cast<std::size_t>(newline - text.data());
+
+        std::string_view line = text.substr(0, length);
+        text.remove_prefix(std::min(length + 1, text.size()));
+
+        if (line.ends_with('\r')) {
+            line.remove_suffix(1);
+        }
+        return line;
+    }
+
+    void skipSpaces(const char*& cursor, const char* end) {
+        while (cursor < end && (*cursor == ' ' || *cursor == '\t')) {
+            ++cursor;
+        }
+    }
+
+    bool parseFloat(const char*& cursor, const char* end, glm::float32_t& value) {
+        skipSpaces(cursor, end);
+#if defined(__cpp_lib_to_chars)
+        const auto [next, error] = std::from_chars(cursor, end, value);
+        if (error != std::errc{}) {
+            return false;
+        }
+        cursor = next;
+#else
+        // Floating point from_chars is not available everywhere, strtof needs a terminated copy of the token
+        std::array<char, 64> token{};
+        std::size_t length = 0;
+        while (cursor + length < end && length + 1 < token.size() &&
+               cursor[length] != ' ' && cursor[length] != '\t') {
+            token[length] = cursor[length];
+            ++length;
+        }
+        char* next = nullptr;
+        value = std::strtof(token.data(), &next);
+        if (next == token.data()) {
+            return false;
+        }
+        cursor += next - token.data();
+#endif
+        return true;
+    }
+
+    // OBJ indices are 1-based, or relative to the end when negative
+    bool parseIndex(const char*& cursor, const char* end, const std::uint32_t declaredAmount, std::uint32_t& index) {
+        std::int64_t value = 0;
+        const auto [next, error] = std::from_chars(cursor, end, value);
+        // Only elements declared so far can be referenced
+        if (error != std::errc{} || value == 0 || value > declaredAmount || -value > declaredAmount) {
+            return false;
+        }
+        cursor = next;
+
+        index = static_cast<std::uint32_t>(value > 0 ? value - 1 : declaredAmount + value);
+        return true;
+    }
+
+    // Need to parse 3 triplets of either form:
+    // v1 v2 v3 | v1/vt1 v2/vt2 v3/vt3 | v1/vt1/vn1 v2/vt2/vn2 v3/vt3/vn3 | v1//vn1 v2//vn2 v3//vn3
+    bool parseFace(std::string_view line, ObjChunk& chunk) {
+        const char* cursor = line.data() + 2; // Discard 'f '
+        const char* end = line.data() + line.size();
+
+        const auto verticesDeclared = chunk.verticesBefore + static_cast<std::uint32_t>(chunk.vertices.size());
+        const auto uvsDeclared = chunk.uvsBefore + static_cast<std::uint32_t>(chunk.uvs.size());
+
+        std::array<std::uint32_t, 3> v{}, vt{};
+        std::uint32_t uvsAmount = 0;
+        for (std::size_t f = 0; f < 3; ++f) {
+            skipSpaces(cursor, end);
+            if (!parseIndex(cursor, end, verticesDeclared, v[f])) {
                 return false;
             }
+
+            if (cursor < end && *cursor == '/') {
+                ++cursor;
+                if (cursor < end && *cursor != '/') {
+                    if (!parseIndex(cursor, end, uvsDeclared, vt[uvsAmount++])) {
+                        return false;
+                    }
+                }
+                // Normals are not used nor counted, only their syntax is checked
+                if (cursor < end && *cursor == '/') {
+                    ++cursor;
+                    std::int64_t vn = 0;
+                    const auto [next, error] = std::from_chars(cursor, end, vn);
+                    if (error != std::errc{} || vn == 0) {
+                        return false;
+                    }
+                    cursor = next;
+                }
+            }
+        }
+        // Texture coordinates are either given for every corner or none
+        if (uvsAmount != 0 && uvsAmount != 3) {
+            return false;
         }
 
+        chunk.faceIndices.insert(chunk.faceIndices.end(), v.begin(), v.end());
+        chunk.uvIndices.insert(chunk.uvIndices.end(), vt.begin(), vt.begin() + uvsAmount);
         return true;
     }
-}
 
-namespace rasterizer {
-    inline Mesh parseObj(const std::filesystem::path& objPath) {
-        std::ifstream file(objPath);
-        if (!file.is_open()) {
-            throw std::runtime_error("Failed to open file: " + objPath.string());
+    void countChunk(ObjChunk& chunk) {
+        for (std::string_view text = chunk.text; !text.empty();) {
+            const auto line = nextLine(text);
+            chunk.linesAmount++;
+
+            if (line.starts_with("v ")) {
+                chunk.verticesAmount++;
+            } else if (line.starts_with("vt ")) {
+                chunk.uvsAmount++;
+            } else if (line.starts_with("f ")) {
+                chunk.facesAmount++;
+            }
         }
+    }
 
-        std::vector<glm::vec3> vertices;
-        std::vector<glm::vec2> uvs;
-        std::vector<std::uint32_t> faceIndices;
-        std::vector<std::uint32_t> uvIndices;
+    void parseChunk(ObjChunk& chunk) {
+        chunk.vertices.reserve(chunk.verticesAmount);
+        chunk.uvs.reserve(chunk.uvsAmount);
+        chunk.faceIndices.reserve(3 * chunk.facesAmount);
+        chunk.uvIndices.reserve(chunk.uvsAmount > 0 || chunk.uvsBefore > 0 ? 3 * chunk.facesAmount : 0);
+
+        std::uint32_t lineCount = chunk.firstLine;
+        for (std::string_view text = chunk.text; !text.empty(); ++lineCount) {
+            const auto line = nextLine(text);
+            const char* end = line.data() + line.size();
 
-        std::string line;
-        for (std::uint32_t lineCount = 0; std::getline(file, line); ++lineCount) {
             if (line.empty() || line.starts_with('#')) {
                 // Skip empty lines and comments
                 continue;
             }
 
             if (line.starts_with("v ")) {
-                if (glm::vec3 vertex;
-                    std::sscanf(line.c_str(), "v %f %f %f", &vertex[0], &vertex[1], &vertex[2]) == 3) {
-                    vertices.emplace_back(vertex);
+                const char* cursor = line.data() + 2;
+                if (glm::vec3 vertex; parseFloat(cursor, end, vertex[0]) && parseFloat(cursor, end, vertex[1]) &&
+                                      parseFloat(cursor, end, vertex[2])) {
+                    chunk.vertices.emplace_back(vertex);
                 } else {
                     rasterizer::print(std::cerr, "Failed to parse vertex line {}: {}", lineCount, line);
+                    chunk.hasMalformedElement = true;
                 }
             } else if (line.starts_with("f ")) {
-                if (!parseFace(line, faceIndices, uvIndices)) {
+                if (!parseFace(line, chunk)) {
                     rasterizer::print(std::cerr, "Failed to parse face line {}: {}", lineCount, line);
                 }
             } else if (line.starts_with("vt ")) {
-                if (glm::vec2 uv; std::sscanf(line.c_str(), "vt %f %f", &uv[0], &uv[1]) == 2) {
-                    uvs.emplace_back(uv);
+                const char* cursor = line.data() + 3;
+                if (glm::vec2 uv; parseFloat(cursor, end, uv[0]) && parseFloat(cursor, end, uv[1])) {
+                    chunk.uvs.emplace_back(uv);
                 } else {
                     rasterizer::print(std::cerr, "Failed to parse uv line {}: {}", lineCount, line);
+                    chunk.hasMalformedElement = true;
                 }
             }
         }
+    }
+
+    // Splits text into roughly chunksAmount chunks that end on line boundaries
+    std::vector<ObjChunk> splitChunks(const std::string_view text, const std::size_t chunksAmount) {
+        std::vector<ObjChunk> chunks;
+        std::size_t begin = 0;
+        for (std::size_t c = 1; c <= chunksAmount && begin < text.size(); ++c) {
+            std::size_t end = c == chunksAmount ? text.size() : std::max(text.size() * c / chunksAmount, begin);
+            if (end < text.size()) {
+                const std::size_t newline = text.find('\n', end);
+                end = newline == std::string_view::npos ? text.size() : newline + 1;
+            }
+
+            chunks.emplace_back().text = text.substr(begin, end - begin);
+            begin = end;
+        }
+        return chunks;
+    }
+
+    template<typename Function>
+    void forEachChunk(rasterizer::ThreadPool* pool, std::vector<ObjChunk>& chunks, const Function& function) {
+        if (pool == nullptr || chunks.size() == 1) {
+            for (auto& chunk : chunks) {
+                function(chunk);
+            }
+            return;
+        }
+
+        pool->parallelFor(chunks.size(), [&](const std::size_t chunk) { function(chunks[chunk]); });
+    }
 
-        // Tighten vectors
-        vertices.shrink_to_fit();
-        uvs.shrink_to_fit();
-        faceIndices.shrink_to_fit();
-        uvIndices.shrink_to_fit();
+    template<typename T>
+    std::vector<T> concatenate(std::vector<ObjChunk>& chunks, std::vector<T> ObjChunk::* member) {
+        if (chunks.size() == 1) {
+            return std::move(chunks.front().*member);
+        }
 
-        file.close();
+        std::size_t total = 0;
+        for (const auto& chunk : chunks) {
+            total += (chunk.*member).size();
+        }
+
+        std::vector<T> result;
+        result.reserve(total);
+        for (auto& chunk : chunks) {
+            result.insert(result.end(), (chunk.*member).begin(), (chunk.*member).end());
+            (chunk.*member) = {};
+        }
+        return result;
+    }
+
+    rasterizer::Mesh buildMesh(const std::string_view name, const rasterizer::AssetSource& source,
+                               const rasterizer::VertexFormat vertexFormat,
+                               std::vector<glm::vec3> vertices, std::vector<glm::vec2> uvs,
+                               std::vector<std::uint32_t> faceIndices, std::vector<std::uint32_t> uvIndices,
+                               rasterizer::MeshBuildStatistics* statistics) {
+        static constexpr std::size_t MAX_LODS = 6;
+        static constexpr std::size_t MIN_LOD_FACES = 32;
+
+        // Bounding sphere centered at the bounding box center
+        glm::vec3 min{std::numeric_limits<glm::float32_t>::max()};
+        glm::vec3 max{std::numeric_limits<glm::float32_t>::lowest()};
+        for (const auto& vertex : vertices) {
+            min = glm::min(min, vertex);
+            max = glm::max(max, vertex);
+        }
+        const glm::vec3 center = vertices.empty() ? glm::vec3{0.0f} : (min + max) / 2.0f;
+        glm::float32_t radius = 0.0f;
+        for (const auto& vertex : vertices) {
+            radius = std::max(radius, glm::length(vertex - center));
+        }
+
+        // Level of detail chain, each level targets half the faces of the previous one
+        // Levels are always simplified from full detail so that their error is relative to it
+        std::vector<rasterizer::Simplification> simplifications;
+        simplifications.emplace_back(rasterizer::Simplification{
+            .faceIndices = std::move(faceIndices), .uvIndices = std::move(uvIndices), .error = 0.0f
+        });
+        while (simplifications.size() < MAX_LODS) {
+            const std::size_t previousFacesAmount = simplifications.back().faceIndices.size() / 3;
+            if (previousFacesAmount / 2 < MIN_LOD_FACES) {
+                break;
+            }
+
+            auto simplification = rasterizer::simplify(vertices,
+                                                       simplifications.front().faceIndices,
+                                                       simplifications.front().uvIndices,
+                                                       previousFacesAmount / 2);
+
+            // Stop once the mesh cannot be meaningfully reduced any further
+            if (simplification.faceIndices.size() / 3 > previousFacesAmount * 9 / 10) {
+                break;
+            }
+            simplifications.emplace_back(std::move(simplification));
+        }
+
+        // Weld every level into a single vertex array, coarser levels reuse the full detail vertices
+        rasterizer::VertexWelder welder(vertices, uvs);
+        std::vector<std::vector<std::uint32_t>> lodIndices;
+        lodIndices.reserve(simplifications.size());
+        for (const auto& simplification : simplifications) {
+            lodIndices.emplace_back(welder.weld(simplification.faceIndices, simplification.uvIndices));
+        }
+        welder.vertices.shrink_to_fit();
+        const std::size_t verticesAmount = welder.vertices.size();
+        const glm::float32_t acmrBefore = rasterizer::computeAcmr(lodIndices.front(), verticesAmount);
+
+        std::vector<rasterizer::MeshletSet> meshlets;
+        meshlets.reserve(simplifications.size());
+        for (auto& indices : lodIndices) {
+            // Cache friendly face order, meshlets are then seeded and grown following it
+            rasterizer::optimizeVertexCache(indices, verticesAmount);
+            // Reorders faces so that each meshlet covers a contiguous range
+            meshlets.emplace_back(rasterizer::buildMeshlets(welder.vertices, welder.positionIndices, indices));
+        }
+
+        // Lay vertices out in the order they are first fetched, full detail first
+        std::vector<const std::vector<std::uint32_t>*> indexBuffers;
+        for (const auto& indices : lodIndices) {
+            indexBuffers.emplace_back(&indices);
+        }
+        const auto remap = rasterizer::computeVertexFetchRemap(indexBuffers, verticesAmount);
+
+        std::vector<rasterizer::Vertex> remappedVertices(verticesAmount);
+        for (std::size_t v = 0; v < verticesAmount; ++v) {
+            remappedVertices[remap[v]] = welder.vertices[v];
+        }
+        for (std::size_t lod = 0; lod < lodIndices.size(); ++lod) {
+            for (auto& index : lodIndices[lod]) {
+                index = remap[index];
+            }
+            for (auto& index : meshlets[lod].vertices) {
+                index = remap[index];
+            }
+        }
+
+        if (statistics != nullptr) {
+            statistics->acmrBefore = acmrBefore;
+            statistics->acmrAfter = rasterizer::computeAcmr(lodIndices.front(), verticesAmount);
+        }
+
+        std::vector<rasterizer::MeshLodBuffers> lods;
+        lods.reserve(simplifications.size());
+        for (std::size_t lod = 0; lod < simplifications.size(); ++lod) {
+            const auto& indices = lodIndices[lod];
+            const std::size_t facesAmount = indices.size() / 3;
+
+            // Per face attributes that do not change from frame to frame
+            std::vector<glm::vec3> faceNormals(facesAmount);
+            std::vector<rasterizer::color_t> faceColors(facesAmount);
+            for (std::size_t face = 0; face < facesAmount; ++face) {
+                const auto& v0 = remappedVertices[indices[3 * face]].position;
+                const auto& v1 = remappedVertices[indices[3 * face + 1]].position;
+                const auto& v2 = remappedVertices[indices[3 * face + 2]].position;
+
+                // Same winding as computeNormal
+                const auto normal = glm::cross(v1 - v0, v2 - v0);
+                const glm::float32_t length = glm::length(normal);
+                faceNormals[face] = length > 0.0f ? normal / length : glm::vec3{0.0f};
+                faceColors[face] = rasterizer::randomColor(face);
+            }
+
+            lods.emplace_back(rasterizer::MeshLodBuffers{
+                .indices = std::move(lodIndices[lod]),
+                .faceNormals = std::move(faceNormals), .faceColors = std::move(faceColors),
+                .meshlets = std::move(meshlets[lod]), .error = simplifications[lod].error
+            });
+        }
+
+        rasterizer::MeshBuffers mesh{};
+        mesh.vertexFormat = vertexFormat;
+        mesh.lods = std::move(lods);
+        mesh.center = center;
+        mesh.radius = radius;
+        if (vertexFormat == rasterizer::VertexFormat::QUANTIZED16) {
+            mesh.quantization = rasterizer::VertexQuantization::fit(remappedVertices);
+            mesh.quantizedVertices.reserve(remappedVertices.size());
+            for (const auto& vertex : remappedVertices) {
+                mesh.quantizedVertices.emplace_back(mesh.quantization.quantize(vertex));
+            }
+
+            // Keep bounds conservative for the positions actually drawn
+            const glm::float32_t error = mesh.quantization.positionError();
+            mesh.radius += error;
+            for (auto& lod : mesh.lods) {
+                for (auto& meshlet : lod.meshlets.meshlets) {
+                    meshlet.radius += error;
+                }
+            }
+        } else {
+            mesh.vertices = std::move(remappedVertices);
+        }
+
+        // Built meshes live in the same layout as mapped mesh files
+        auto image = std::make_shared<const std::vector<std::byte>>(rasterizer::serializeMesh(source, mesh));
+        const std::span<const std::byte> bytes(*image);
+        auto built = rasterizer::viewMesh(std::move(image), bytes);
+        if (!built) {
+            throw std::runtime_error(std::format("Built mesh failed validation: {}", name));
+        }
+        return std::move(*built);
+    }
+}
+
+namespace rasterizer {
+    /*
+     * The file is memory-mapped and scanned twice: a counting pass sizes every vector up front,
+     * then each line is tokenized by hand and numbers are read with std::from_chars.
+     * Given a pool, files of at least 2 * MIN_CHUNK_BYTES are split at line boundaries and both passes run
+     * on the calling thread and the idle workers of the pool.
+     */
+    inline Mesh parseObj(const std::filesystem::path& objPath,
+                         const VertexFormat vertexFormat = VertexFormat::FLOAT32,
+                         MeshBuildStatistics* statistics = nullptr, ThreadPool* pool = nullptr) {
+        // Smaller chunks cost more to hand over than they save
+        static constexpr std::size_t MIN_CHUNK_BYTES = 4 * 1024 * 1024;
+
+        const MappedFile file(objPath);
+        const auto text = file.text();
+
+        const std::size_t chunksAmount = pool == nullptr ? 1 : std::clamp<std::size_t>(text.size() / MIN_CHUNK_BYTES,
+                                                                                         1, pool->size() + 1);
+        auto chunks = splitChunks(text, chunksAmount);
+        if (chunks.empty()) {
+            chunks.emplace_back();
+        }
+
+        forEachChunk(pool, chunks, countChunk);
+
+        // Line numbers and declared elements before each chunk
+        for (std::size_t c = 1; c < chunks.size(); ++c) {
+            chunks[c].firstLine = chunks[c - 1].firstLine + chunks[c - 1].linesAmount;
+            chunks[c].verticesBefore = chunks[c - 1].verticesBefore + chunks[c - 1].verticesAmount;
+            chunks[c].uvsBefore = chunks[c - 1].uvsBefore + chunks[c - 1].uvsAmount;
+        }
+
+        forEachChunk(pool, chunks, parseChunk);
+
+        // Faces were checked against the counted elements, which only hold if every element parsed
+        if (std::ranges::any_of(chunks, &ObjChunk::hasMalformedElement)) {
+            throw std::runtime_error(std::format("Malformed vertex or uv in OBJ: {}", objPath.string()));
+        }
+
+        auto vertices = concatenate(chunks, &ObjChunk::vertices);
+        auto uvs = concatenate(chunks, &ObjChunk::uvs);
+        auto faceIndices = concatenate(chunks, &ObjChunk::faceIndices);
+        auto uvIndices = concatenate(chunks, &ObjChunk::uvIndices);
+        const auto isBelow = [](const std::size_t limit) {
+            return [limit](const std::uint32_t index) { return index < limit; };
+        };
+        if (!std::ranges::all_of(faceIndices, isBelow(vertices.size())) ||
+            !std::ranges::all_of(uvIndices, isBelow(uvs.size()))) {
+            throw std::runtime_error(std::format("Out of range index in OBJ: {}", objPath.string()));
+        }
+
+        return buildMesh(objPath.filename().string(), describeSource(objPath, {file.data(), file.bytesAmount()}),
+                         vertexFormat, std::move(vertices), std::move(uvs), std::move(faceIndices),
+                         std::move(uvIndices), statistics);
+    }
+
+    // Loads an OBJ through the mesh file next to it, which is (re)built from the OBJ when missing or stale
+    inline Mesh loadMesh(const std::filesystem::path& objPath,
+                         const VertexFormat vertexFormat = VertexFormat::FLOAT32, ThreadPool* pool = nullptr) {
+        auto meshPath = objPath;
+        meshPath.replace_extension(MESH_FILE_EXTENSION);
+
+        if (auto mesh = readMeshFile(meshPath);
+            mesh && mesh->vertexFormat == vertexFormat && isSourceUnchanged(meshSource(*mesh), objPath)) {
+            return std::move(*mesh);
+        }
+
+        // Only reported on (re)builds, loading an up to date mesh file does not reorder anything
+        MeshBuildStatistics statistics;
+        auto mesh = parseObj(objPath, vertexFormat, &statistics, pool);
+        rasterizer::print("{}: ACMR {:.3f} -> {:.3f}\n", objPath.filename().string(),
+                          statistics.acmrBefore, statistics.acmrAfter);
+        if (!writeAssetFile(meshPath, mesh.image)) {
+            rasterizer::print("{}: could not write {}\n", objPath.filename().string(), meshPath.string());
+        }
 
-        return {.vertices = vertices, .uvs = uvs, .faceIndices = faceIndices, .uvIndices = uvIndices};
+        return mesh;
     }
 }
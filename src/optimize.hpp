@@ -0,0 +1,168 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace rasterizer {
+    // Size of the FIFO post-transform cache the optimizations and statistics are tuned for
+    static constexpr std::size_t VERTEX_CACHE_SIZE = 16;
+
+    // Average cache miss ratio: transformed vertices per face through a FIFO cache, lower is better (>= 0.5)
+    inline glm::float32_t computeAcmr(const std::vector<std::uint32_t>& indices, const std::size_t verticesAmount,
+                                      const std::size_t cacheSize = VERTEX_CACHE_SIZE) {
+        if (indices.empty()) {
+            return 0.0f;
+        }
+
+        // A vertex is in the cache if it was pushed less than cacheSize misses ago
+        std::vector<std::size_t> pushedAt(verticesAmount, 0);
+        std::size_t misses = 0;
+        for (const auto vertex : indices) {
+            if (pushedAt[vertex] == 0 || misses - pushedAt[vertex] + 1 > cacheSize) {
+                misses++;
+                pushedAt[vertex] = misses;
+            }
+        }
+
+        return static_cast<glm::float32_t>(misses) / static_cast<glm::float32_t>(indices.size() / 3);
+    }
+
+    /*
+     * Reorders faces in place for post-transform vertex cache locality.
+     * Faces are emitted as fans around a vertex, the next fan is chosen among the vertices just touched,
+     * preferring the ones that would still be in the cache once all their remaining faces were emitted.
+     * See: Sander, Nehab & Barczak, Fast Triangle Reordering for Vertex Locality and Reduced Overdraw (Tipsify)
+     */
+    inline void optimizeVertexCache(std::vector<std::uint32_t>& indices, const std::size_t verticesAmount,
+                                    const std::size_t cacheSize = VERTEX_CACHE_SIZE) {
+        static constexpr std::size_t none = std::numeric_limits<std::size_t>::max();
+
+        const std::size_t facesAmount = indices.size() / 3;
+
+        // Vertex -> adjacent faces, in compressed form
+        std::vector<std::uint32_t> adjacencyOffsets(verticesAmount + 1, 0);
+        for (const auto vertex : indices) {
+            adjacencyOffsets[vertex + 1]++;
+        }
+        for (std::size_t v = 0; v < verticesAmount; ++v) {
+            adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+        }
+        std::vector<std::uint32_t> adjacentFaces(indices.size());
+        {
+            auto cursor = adjacencyOffsets;
+            for (std::size_t i = 0; i < indices.size(); ++i) {
+                adjacentFaces[cursor[indices[i]]++] = static_cast<std::uint32_t>(i / 3);
+            }
+        }
+
+        // Faces not yet emitted, per vertex
+        std::vector<std::uint32_t> liveFaces(verticesAmount);
+        for (std::size_t v = 0; v < verticesAmount; ++v) {
+            liveFaces[v] = adjacencyOffsets[v + 1] - adjacencyOffsets[v];
+        }
+
+        std::vector<std::size_t> cachedAt(verticesAmount, 0);
+        std::size_t time = cacheSize + 1;
+
+        std::vector<bool> isFaceEmitted(facesAmount, false);
+        std::vector<std::uint32_t> reordered;
+        reordered.reserve(indices.size());
+
+        // Recently touched vertices, to resume from when a fan leaves no good candidate
+        std::vector<std::uint32_t> deadEnds;
+        std::vector<std::uint32_t> candidates;
+        std::size_t nextUnvisited = 0;
+
+        const auto nextVertex = [&]() -> std::size_t {
+            std::size_t best = none;
+            std::size_t bestPriority = 0;
+            for (const auto candidate : candidates) {
+                if (liveFaces[candidate] == 0) {
+                    continue;
+                }
+
+                // Vertices that would fall out of the cache while fanning around them are not worth it
+                std::size_t priority = 1;
+                if (time - cachedAt[candidate] + 2 * liveFaces[candidate] <= cacheSize) {
+                    priority += time - cachedAt[candidate];
+                }
+                if (best == none || priority > bestPriority) {
+                    best = candidate;
+                    bestPriority = priority;
+                }
+            }
+            if (best != none) {
+                return best;
+            }
+
+            while (!deadEnds.empty()) {
+                const auto vertex = deadEnds.back();
+                deadEnds.pop_back();
+                if (liveFaces[vertex] > 0) {
+                    return vertex;
+                }
+            }
+
+            while (nextUnvisited < verticesAmount) {
+                if (liveFaces[nextUnvisited] > 0) {
+                    return nextUnvisited;
+                }
+                nextUnvisited++;
+            }
+
+            return none;
+        };
+
+        for (std::size_t fanning = nextVertex(); fanning != none; fanning = nextVertex()) {
+            candidates.clear();
+            for (auto a = adjacencyOffsets[fanning]; a < adjacencyOffsets[fanning + 1]; ++a) {
+                const auto face = adjacentFaces[a];
+                if (isFaceEmitted[face]) {
+                    continue;
+                }
+
+                for (std::size_t c = 0; c < 3; ++c) {
+                    const auto vertex = indices[3 * face + c];
+                    reordered.emplace_back(vertex);
+                    deadEnds.emplace_back(vertex);
+                    candidates.emplace_back(vertex);
+                    liveFaces[vertex]--;
+                    if (time - cachedAt[vertex] > cacheSize) {
+                        cachedAt[vertex] = time++;
+                    }
+                }
+                isFaceEmitted[face] = true;
+            }
+        }
+
+        indices = std::move(reordered);
+    }
+
+    // Renumbers vertices in order of first use over the given index buffers, returns old index -> new index
+    inline std::vector<std::uint32_t> computeVertexFetchRemap(
+        const std::vector<const std::vector<std::uint32_t>*>& indexBuffers, const std::size_t verticesAmount) {
+        static constexpr std::uint32_t unassigned = std::numeric_limits<std::uint32_t>::max();
+
+        std::vector<std::uint32_t> remap(verticesAmount, unassigned);
+        std::uint32_t nextIndex = 0;
+        for (const auto* indices : indexBuffers) {
+            for (const auto vertex : *indices) {
+                if (remap[vertex] == unassigned) {
+                    remap[vertex] = nextIndex++;
+                }
+            }
+        }
+
+        // Unreferenced vertices go last
+        for (auto& index : remap) {
+            if (index == unassigned) {
+                index = nextIndex++;
+            }
+        }
+
+        return remap;
+    }
+}
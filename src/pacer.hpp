@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+
+#include <SDL2/SDL.h>
+
+namespace rasterizer {
+    /*
+     * Paces the interactive loop to a target frame rate while keeping input latency low.
+     * Instead of sleeping for the rest of the frame period, the loop waits for the next event until the period is
+     * over, so input is picked up and drawn as soon as it arrives rather than after the sleep.
+     */
+    class FramePacer {
+    public:
+        explicit FramePacer(const std::uint32_t framesPerSecond) : period(1000 / framesPerSecond) {
+        }
+
+        // Blocks until the next frame should start, or an event arrives
+        void wait() {
+            if (const std::uint64_t deadline = previousStart + period, now = SDL_GetTicks64(); now < deadline) {
+                // Leaves the event in the queue, it is handled by the frame
+                SDL_WaitEventTimeout(nullptr, static_cast<std::int32_t>(deadline - now));
+            }
+
+            previousStart = SDL_GetTicks64();
+        }
+
+    private:
+        // Milliseconds
+        const std::uint64_t period;
+        std::uint64_t previousStart = 0;
+    };
+}
@@ -0,0 +1,248 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "canvas.hpp"
+#include "polygon.hpp"
+#include "profiler.hpp"
+#include "stats.hpp"
+
+namespace rasterizer {
+    struct TriangleBatch {
+        static constexpr std::size_t CAPACITY = 512;
+
+        std::array<Triangle, CAPACITY> triangles;
+        std::array<TriangleSetup, CAPACITY> setups;
+        std::size_t trianglesAmount = 0;
+    };
+
+    /*
+     * Streams triangles to the raster stage through a bounded ring of RING_SIZE batches.
+     * Each consumer draws every batch in order, clipped to its own band of rows, so the image matches a serial draw.
+     * Without consumers the producer draws directly.
+     */
+    class RasterPipeline {
+    public:
+        static constexpr std::size_t RING_SIZE = 8;
+
+        // Starts threadsAmount consumers, at most one per row, next to the producer thread
+        RasterPipeline(const Canvas& canvas, Profiler& profiler, const std::uint32_t threadsAmount)
+            : canvas(canvas), profiler(profiler) {
+            const std::uint32_t consumersAmount = std::min(threadsAmount, canvas.height);
+
+            consumed.assign(consumersAmount, 0);
+            consumerFragments.resize(consumersAmount);
+            for (std::uint32_t i = 0; i < consumersAmount; ++i) {
+                bands.push_back({
+                    static_cast<std::int32_t>(canvas.height * i / consumersAmount),
+                    static_cast<std::int32_t>(canvas.height * (i + 1) / consumersAmount)
+                });
+            }
+            for (std::uint32_t i = 0; i < consumersAmount; ++i) {
+                consumers.emplace_back([this, i] { consume(i); });
+            }
+        }
+
+        ~RasterPipeline() {
+            {
+                std::lock_guard lock(mutex);
+                isShuttingDown = true;
+            }
+            batchPublished.notify_all();
+
+            for (auto& consumer : consumers) {
+                consumer.join();
+            }
+        }
+
+        RasterPipeline(const RasterPipeline&) = delete;
+        RasterPipeline& operator=(const RasterPipeline&) = delete;
+
+        // Timed per group, reading the clock per triangle costs as much as setup
+        void submit(const std::span<const Triangle> triangles) {
+            std::array<TriangleSetup, TriangleBatch::CAPACITY> setups;
+            for (std::size_t begin = 0; begin < triangles.size(); begin += setups.size()) {
+                const auto group = triangles.subspan(begin, std::min(setups.size(), triangles.size() - begin));
+                {
+                    const Profiler::Scope scope(profiler, Stage::SETUP);
+                    for (std::size_t t = 0; t < group.size(); ++t) {
+                        setups[t] = canvas.classify(group[t]);
+                        count(setups[t]);
+                    }
+                }
+
+                if (consumers.empty()) {
+                    const Profiler::Scope scope(profiler, Stage::RASTER);
+                    for (std::size_t t = 0; t < group.size(); ++t) {
+                        if (canvas.needsRasterization(setups[t])) {
+                            canvas.drawTriangle(group[t], canvas.allRows(), setups[t], fragments);
+                        }
+                    }
+                    continue;
+                }
+
+                for (std::size_t t = 0; t < group.size(); ++t) {
+                    if (canvas.needsRasterization(setups[t])) {
+                        enqueue(group[t], setups[t]);
+                    }
+                }
+            }
+        }
+
+        // Blocks until every submitted triangle has been rasterized
+        void finish() {
+            frameCounters = counters;
+            counters = {};
+
+            if (!consumers.empty()) {
+                if (current != nullptr) {
+                    publish();
+                }
+
+                std::unique_lock lock(mutex);
+                batchReleased.wait(lock, [this] { return oldestConsumed() == published; });
+
+                // Every consumer is idle, restart the sequence for the next frame
+                published = 0;
+                std::ranges::fill(consumed, 0);
+            }
+
+            // Consumers are idle, their counters can be read
+            frameFragments = std::exchange(fragments, {});
+            for (auto& consumer : consumerFragments) {
+                frameFragments += std::exchange(consumer.fragments, {});
+            }
+        }
+
+        // Counters of the last finished frame
+        const TriangleSetupCounters& setupCounters() const {
+            return frameCounters;
+        }
+
+        const FragmentCounters& fragmentCounters() const {
+            return frameFragments;
+        }
+
+    private:
+        // One cache line per consumer, counted on every pixel
+        struct alignas(64) ConsumerFragments {
+            FragmentCounters fragments;
+        };
+
+        const Canvas& canvas;
+        Profiler& profiler;
+
+        // Only touched by the producer
+        TriangleSetupCounters counters;
+        TriangleSetupCounters frameCounters;
+        FragmentCounters fragments;
+        FragmentCounters frameFragments;
+        // Only touched by their consumer until finish()
+        std::vector<ConsumerFragments> consumerFragments;
+
+        std::array<TriangleBatch, RING_SIZE> ring;
+        // Slot being filled by the producer
+        TriangleBatch* current = nullptr;
+
+        std::mutex mutex;
+        std::condition_variable batchPublished;
+        std::condition_variable batchReleased;
+        // Monotonic batch sequence numbers within the current frame, slot = sequence % RING_SIZE
+        std::size_t published = 0;
+        std::vector<std::size_t> consumed;
+        bool isShuttingDown = false;
+
+        std::vector<RowRange> bands;
+        std::vector<std::thread> consumers;
+
+        void count(const TriangleSetup setup) {
+            switch (setup) {
+                case TriangleSetup::ZERO_AREA:
+                    counters.zeroArea++;
+                    break;
+                case TriangleSetup::NO_SAMPLE:
+                    counters.noSample++;
+                    break;
+                case TriangleSetup::MICRO:
+                    counters.micro++;
+                    break;
+                case TriangleSetup::REGULAR:
+                    counters.regular++;
+                    break;
+            }
+        }
+
+        std::size_t oldestConsumed() const {
+            return *std::ranges::min_element(consumed);
+        }
+
+        void enqueue(const Triangle& triangle, const TriangleSetup setup) {
+            if (current == nullptr) {
+                acquire();
+            }
+
+            current->triangles[current->trianglesAmount] = triangle;
+            current->setups[current->trianglesAmount] = setup;
+            current->trianglesAmount++;
+            if (current->trianglesAmount == TriangleBatch::CAPACITY) {
+                publish();
+            }
+        }
+
+        void acquire() {
+            std::unique_lock lock(mutex);
+            // Wait for the slowest consumer to release the slot
+            batchReleased.wait(lock, [this] { return published - oldestConsumed() < RING_SIZE; });
+
+            current = &ring[published % RING_SIZE];
+            current->trianglesAmount = 0;
+        }
+
+        void publish() {
+            {
+                std::lock_guard lock(mutex);
+                published++;
+            }
+            batchPublished.notify_all();
+            current = nullptr;
+        }
+
+        void consume(const std::size_t consumer) {
+            const RowRange band = bands[consumer];
+
+            while (true) {
+                const TriangleBatch* batch;
+                {
+                    std::unique_lock lock(mutex);
+                    batchPublished.wait(lock, [&] { return isShuttingDown || consumed[consumer] < published; });
+                    if (isShuttingDown) {
+                        return;
+                    }
+                    batch = &ring[consumed[consumer] % RING_SIZE];
+                }
+
+                {
+                    const Profiler::Scope scope(profiler, Stage::RASTER);
+                    auto& fragments = consumerFragments[consumer].fragments;
+                    for (std::size_t t = 0; t < batch->trianglesAmount; ++t) {
+                        canvas.drawTriangle(batch->triangles[t], band, batch->setups[t], fragments);
+                    }
+                }
+
+                {
+                    std::lock_guard lock(mutex);
+                    consumed[consumer]++;
+                }
+                batchReleased.notify_one();
+            }
+        }
+    };
+}
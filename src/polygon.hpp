@@ -3,13 +3,15 @@
 #include <array>
 #include <tuple>
 
+#include "texture.hpp"
+
 namespace rasterizer {
     struct Triangle {
         static constexpr color_t defaultSolidColor = 0x4C1D95FF;
 
-        const std::array<glm::vec4, 3> vertices;
-        const std::array<glm::vec2, 3> uvs;
-        const std::array<color_t, 3> colors;
+        std::array<glm::vec4, 3> vertices;
+        std::array<glm::vec2, 3> uvs;
+        std::array<color_t, 3> colors;
         const Surface* surface = nullptr;
     };
 
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "stats.hpp"
+
+namespace rasterizer {
+    // Raster includes shading, both happen per pixel in the same loop
+    enum class Stage : std::uint8_t {
+        CLEAR,
+        TRANSFORM,
+        CULL,
+        CLIP,
+        SETUP,
+        RASTER,
+        UPLOAD,
+        UI,
+    };
+
+    static constexpr std::size_t STAGES_AMOUNT = static_cast<std::size_t>(Stage::UI) + 1;
+
+    inline const char* stageName(const Stage stage) {
+        static constexpr std::array<const char*, STAGES_AMOUNT> names{
+            "Clear", "Transform", "Cull", "Clip", "Setup", "Raster + Shade", "Upload", "UI"
+        };
+        return names[static_cast<std::size_t>(stage)];
+    }
+
+    // Over one frame
+    struct PipelineCounters {
+        // Faces of the meshlets that survived cluster culling
+        std::uint64_t trianglesIn = 0;
+        // Back faces
+        std::uint64_t trianglesCulled = 0;
+        // Entirely outside the frustum
+        std::uint64_t trianglesClipped = 0;
+        // Sent to the raster stage, clipping can split a face into several
+        std::uint64_t trianglesEmitted = 0;
+        FragmentCounters fragments;
+
+        PipelineCounters& operator+=(const PipelineCounters& other) {
+            trianglesIn += other.trianglesIn;
+            trianglesCulled += other.trianglesCulled;
+            trianglesClipped += other.trianglesClipped;
+            trianglesEmitted += other.trianglesEmitted;
+            fragments += other.fragments;
+            return *this;
+        }
+    };
+
+    /*
+     * Time spent per pipeline stage, averaged over the last RollingSamples::CAPACITY frames.
+     * Stages running on several threads at once (transform, cull, clip and raster) report the time summed over
+     * every thread, so they can add up to more than the frame time.
+     * Disabled, a timer costs a single branch and no clock is read.
+     */
+    class Profiler {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        // Times its scope, from any thread
+        class Scope {
+        public:
+            Scope(Profiler& profiler, const Stage stage)
+                : profiler(profiler.isEnabled() ? &profiler : nullptr), stage(stage) {
+                if (this->profiler != nullptr) {
+                    start = Clock::now();
+                }
+            }
+
+            ~Scope() {
+                if (profiler != nullptr) {
+                    profiler->add(stage, Clock::now() - start);
+                }
+            }
+
+            Scope(const Scope&) = delete;
+            Scope& operator=(const Scope&) = delete;
+
+        private:
+            Profiler* const profiler;
+            const Stage stage;
+            Clock::time_point start{};
+        };
+
+        bool isEnabled() const {
+            return enabled.load(std::memory_order_relaxed);
+        }
+
+        void setEnabled(const bool isEnabled) {
+            enabled.store(isEnabled, std::memory_order_relaxed);
+        }
+
+        void add(const Stage stage, const Clock::duration duration) {
+            stageNanoseconds[static_cast<std::size_t>(stage)].fetch_add(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count(), std::memory_order_relaxed);
+        }
+
+        // Closes the frame, once every stage of it has finished
+        void endFrame(const Clock::duration frameTime, const PipelineCounters& counters,
+                      const std::uint64_t pixelsAmount) {
+            frameCounters = counters;
+            framePixelsAmount = pixelsAmount;
+
+            // Drained even when disabled, scopes opened before disabling still add to this frame
+            const bool isRecorded = isEnabled();
+            if (isRecorded) {
+                frameTimes.add(toMilliseconds(frameTime));
+            }
+            for (std::size_t stage = 0; stage < STAGES_AMOUNT; ++stage) {
+                const auto nanoseconds = stageNanoseconds[stage].exchange(0, std::memory_order_relaxed);
+                if (isRecorded) {
+                    stageTimes[stage].add(toMilliseconds(std::chrono::nanoseconds(nanoseconds)));
+                }
+            }
+        }
+
+        // Milliseconds
+        const RollingSamples& frameTime() const {
+            return frameTimes;
+        }
+
+        const RollingSamples& stageTime(const Stage stage) const {
+            return stageTimes[static_cast<std::size_t>(stage)];
+        }
+
+        const PipelineCounters& counters() const {
+            return frameCounters;
+        }
+
+        // Fragments written per canvas pixel
+        float overdraw() const {
+            return framePixelsAmount > 0
+                       ? static_cast<float>(frameCounters.fragments.passed) / static_cast<float>(framePixelsAmount)
+                       : 0.0f;
+        }
+
+    private:
+        std::atomic<bool> enabled = false;
+        std::array<std::atomic<std::int64_t>, STAGES_AMOUNT> stageNanoseconds{};
+
+        RollingSamples frameTimes;
+        std::array<RollingSamples, STAGES_AMOUNT> stageTimes;
+        PipelineCounters frameCounters;
+        std::uint64_t framePixelsAmount = 0;
+
+        static float toMilliseconds(const Clock::duration duration) {
+            return std::chrono::duration<float, std::milli>(duration).count();
+        }
+    };
+}
@@ -0,0 +1,306 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "arena.hpp"
+#include "mesh.hpp"
+#include "obj.hpp"
+#include "surface_file.hpp"
+#include "texture.hpp"
+#include "thread_pool.hpp"
+
+namespace rasterizer {
+    // Model-space bounding sphere
+    struct MeshBounds {
+        glm::vec3 center;
+        glm::float32_t radius;
+    };
+
+    /*
+     * Keeps the assets of a scene within a memory budget, evicting the least recently drawn ones.
+     * Requested assets load in the background, until then meshes are skipped and surfaces use a placeholder.
+     * Assets only change in update(), so requested ones stay valid for the whole frame.
+     */
+    class ResidencyManager {
+    public:
+        static constexpr std::size_t DEFAULT_BUDGET_BYTES = 512 * 1024 * 1024;
+
+        explicit ResidencyManager(const std::size_t budgetBytes = DEFAULT_BUDGET_BYTES)
+            : budgetBytes(budgetBytes), placeholder(createPlaceholder()) {
+        }
+
+        // Returns the index instances reference the asset by
+        std::size_t addMesh(const std::filesystem::path& path,
+                            const VertexFormat vertexFormat = VertexFormat::FLOAT32) {
+            meshes.emplace_back().path = path;
+            meshFormats.emplace_back(vertexFormat);
+            meshBounds.emplace_back(cachedBounds(path, vertexFormat));
+            return meshes.size() - 1;
+        }
+
+        std::size_t addSurface(const std::filesystem::path& path) {
+            surfaces.emplace_back().path = path;
+            return surfaces.size() - 1;
+        }
+
+        // Resident mesh, nullptr while it streams in
+        const Mesh* requestMesh(const std::size_t mesh) {
+            return request(meshes[mesh], [this, vertexFormat = meshFormats[mesh]](const std::filesystem::path& path) {
+                // Large OBJs are parsed on the idle loading threads as well
+                return std::make_shared<const Mesh>(rasterizer::loadMesh(path, vertexFormat, &loader));
+            }).get();
+        }
+
+        // Resident surface, the placeholder while it streams in or if it could not be loaded
+        const Surface* requestSurface(const std::size_t surface) {
+            const Surface* resident = request(surfaces[surface], [](const std::filesystem::path& path) {
+                return std::shared_ptr<Surface>(rasterizer::loadSurface(path));
+            }).get();
+
+            return resident != nullptr ? resident : placeholder.get();
+        }
+
+        // Known once loaded or from an up to date mesh file, kept after eviction
+        const std::optional<MeshBounds>& bounds(const std::size_t mesh) const {
+            return meshBounds[mesh];
+        }
+
+        // Frame boundary: picks up finished loads (rethrowing their errors) and evicts down to the budget
+        void update() {
+            frame++;
+
+            collectAll();
+
+            if (residentBytes() > budgetBytes) {
+                evict();
+            }
+        }
+
+        // Blocks until every requested asset is resident, within the current frame
+        void finishLoading() {
+            const auto wait = [](auto& entries) {
+                for (auto& entry : entries) {
+                    if (entry.loading.valid()) {
+                        entry.loading.wait();
+                    }
+                }
+            };
+            wait(meshes);
+            wait(surfaces);
+
+            collectAll();
+        }
+
+        // Changes whenever an asset becomes resident or is evicted
+        std::uint64_t revision() const {
+            return residencyRevision;
+        }
+
+        bool isLoading() const {
+            const auto isPending = [](const auto& entry) { return entry.loading.valid(); };
+            return std::ranges::any_of(meshes, isPending) || std::ranges::any_of(surfaces, isPending);
+        }
+
+        std::size_t residentBytes() const {
+            std::size_t bytesAmount = 0;
+            for (const auto& entry : meshes) {
+                bytesAmount += entry.bytesAmount;
+            }
+            for (const auto& entry : surfaces) {
+                bytesAmount += entry.bytesAmount;
+            }
+
+            return bytesAmount;
+        }
+
+        void lock() const {
+            placeholder->lock();
+            for (const auto& entry : surfaces) {
+                if (entry.asset != nullptr) {
+                    entry.asset->lock();
+                }
+            }
+        }
+
+        void unlock() const {
+            placeholder->unlock();
+            for (const auto& entry : surfaces) {
+                if (entry.asset != nullptr) {
+                    entry.asset->unlock();
+                }
+            }
+        }
+
+    private:
+        template<typename Asset>
+        struct ResidentAsset {
+            std::filesystem::path path;
+            std::shared_ptr<Asset> asset = nullptr;
+            // Valid while loading
+            std::future<std::shared_ptr<Asset>> loading;
+            std::size_t bytesAmount = 0;
+            std::uint64_t lastUsedFrame = 0;
+            // Failed to load, not retried
+            bool isMissing = false;
+        };
+
+        const std::size_t budgetBytes;
+        std::uint64_t frame = 0;
+        std::uint64_t residencyRevision = 0;
+
+        std::vector<ResidentAsset<const Mesh>> meshes;
+        std::vector<VertexFormat> meshFormats;
+        std::vector<std::optional<MeshBounds>> meshBounds;
+        std::vector<ResidentAsset<Surface>> surfaces;
+        const std::unique_ptr<Surface> placeholder;
+
+        // Declared last, destroyed first: in flight loads finish before their assets go away
+        ThreadPool loader{loadingThreadsAmount(), [] { ++uncountedAllocationsDepth; }};
+
+        static std::size_t loadingThreadsAmount() {
+#ifdef __EMSCRIPTEN__
+            // No threads, assets are loaded on request
+            return 0;
+#else
+            // Leaves the cores to rendering, a second thread overlaps file access
+            return std::thread::hardware_concurrency() >= 4 ? 2 : 1;
+#endif
+        }
+
+        // Bounds from the header of the mesh file of an unchanged OBJ
+        static std::optional<MeshBounds> cachedBounds(const std::filesystem::path& objPath,
+                                                      const VertexFormat vertexFormat) {
+            auto meshPath = objPath;
+            meshPath.replace_extension(MESH_FILE_EXTENSION);
+
+            const auto header = readMeshFileHeader(meshPath);
+            if (!header || header->vertexFormat != vertexFormat) {
+                return std::nullopt;
+            }
+            // Content hashes are only compared on load, which recomputes the bounds
+            if (const auto source = statSource(objPath);
+                source && (source->bytesAmount != header->source.bytesAmount
+                           || source->modified != header->source.modified)) {
+                return std::nullopt;
+            }
+
+            return MeshBounds{.center = header->center, .radius = header->radius};
+        }
+
+        // Grey checkerboard, 8x8 pixels per square
+        static std::unique_ptr<Surface> createPlaceholder() {
+            static constexpr std::uint32_t SIZE = 16;
+
+            std::array<std::uint32_t, SIZE * SIZE> pixels{};
+            for (std::uint32_t y = 0; y < SIZE; ++y) {
+                for (std::uint32_t x = 0; x < SIZE; ++x) {
+                    pixels[y * SIZE + x] = (x / 8 + y / 8) % 2 == 0 ? 0xFF808080 : 0xFFB0B0B0;
+                }
+            }
+
+            auto* surface = rasterizer::loadDataSurface(pixels.data(), SIZE, SIZE);
+            if (surface == nullptr) {
+                throw std::runtime_error("Placeholder surface could not be created");
+            }
+
+            return std::unique_ptr<Surface>(surface);
+        }
+
+        static std::size_t footprint(const Mesh& mesh) {
+            return sizeof(Mesh) + mesh.lods.size() * sizeof(MeshLod) + mesh.image.size();
+        }
+
+        static std::size_t footprint(const Surface& surface) {
+            return sizeof(Surface) + static_cast<std::size_t>(surface.width) * surface.height * sizeof(color_t);
+        }
+
+        template<typename Asset, typename Load>
+        const std::shared_ptr<Asset>& request(ResidentAsset<Asset>& entry, const Load& load) {
+            entry.lastUsedFrame = frame;
+            if (entry.asset == nullptr && !entry.loading.valid() && !entry.isMissing) {
+                // Without loading threads the asset is loaded right away
+                const UncountedAllocations loading;
+                entry.loading = loader.submit([path = entry.path, load] { return load(path); });
+            }
+
+            return entry.asset;
+        }
+
+        void collectAll() {
+            collect(meshes);
+            collect(surfaces);
+            for (std::size_t mesh = 0; mesh < meshes.size(); ++mesh) {
+                // Loaded bounds supersede cached ones
+                if (const auto& asset = meshes[mesh].asset; asset != nullptr) {
+                    meshBounds[mesh] = MeshBounds{.center = asset->center, .radius = asset->radius};
+                }
+            }
+        }
+
+        template<typename Asset>
+        void collect(std::vector<ResidentAsset<Asset>>& entries) {
+            for (auto& entry : entries) {
+                if (!entry.loading.valid()
+                    || entry.loading.wait_for(std::chrono::seconds::zero()) != std::future_status::ready) {
+                    continue;
+                }
+
+                entry.asset = entry.loading.get();
+                entry.isMissing = entry.asset == nullptr;
+                entry.bytesAmount = entry.asset != nullptr ? footprint(*entry.asset) : 0;
+                residencyRevision++;
+            }
+        }
+
+        void evict() {
+            struct Candidate {
+                std::uint64_t lastUsedFrame;
+                bool isMesh;
+                std::size_t index;
+            };
+
+            // Anything requested in this or the previous frame is in use
+            std::vector<Candidate> candidates;
+            for (std::size_t mesh = 0; mesh < meshes.size(); ++mesh) {
+                if (meshes[mesh].asset != nullptr && meshes[mesh].lastUsedFrame + 1 < frame) {
+                    candidates.push_back({meshes[mesh].lastUsedFrame, true, mesh});
+                }
+            }
+            for (std::size_t surface = 0; surface < surfaces.size(); ++surface) {
+                if (surfaces[surface].asset != nullptr && surfaces[surface].lastUsedFrame + 1 < frame) {
+                    candidates.push_back({surfaces[surface].lastUsedFrame, false, surface});
+                }
+            }
+            std::ranges::sort(candidates, {}, &Candidate::lastUsedFrame);
+
+            std::size_t bytesAmount = residentBytes();
+            const auto release = [&](auto& entry) {
+                bytesAmount -= entry.bytesAmount;
+                entry.bytesAmount = 0;
+                entry.asset = nullptr;
+                residencyRevision++;
+            };
+            for (const auto& candidate : candidates) {
+                if (bytesAmount <= budgetBytes) {
+                    break;
+                }
+                if (candidate.isMesh) {
+                    release(meshes[candidate.index]);
+                } else {
+                    release(surfaces[candidate.index]);
+                }
+            }
+        }
+    };
+}
@@ -1,64 +1,88 @@
 #pragma once
 
-#include <memory>
+#include <cstdint>
 #include <vector>
 
-#include "mesh.hpp"
+#include "instance.hpp"
 #include "light.hpp"
-#include "obj.hpp"
-#include "texture.hpp"
+#include "residency.hpp"
 
 namespace rasterizer {
     class Scene {
     public:
-        std::vector<Mesh> meshes;
-        std::vector<std::shared_ptr<Surface>> meshSurfaces;
+        // Unique assets, referenced by index from instances
+        mutable ResidencyManager residency;
         DirectionalLight light{{0.0f, -1.0f, 0.0f}};
 
-        explicit Scene()
-            : meshes({
-                  rasterizer::parseObj("../assets/mesh/runway.obj"),
-                  rasterizer::parseObj("../assets/mesh/f22.obj"),
-                  rasterizer::parseObj("../assets/mesh/efa.obj"),
-                  rasterizer::parseObj("../assets/mesh/f117.obj"),
-              }),
-              surfaces({
-                  std::shared_ptr<Surface>(rasterizer::loadPngSurface("../assets/mesh/runway.png")),
-                  std::shared_ptr<Surface>(rasterizer::loadPngSurface("../assets/mesh/f22.png")),
-                  std::shared_ptr<Surface>(rasterizer::loadPngSurface("../assets/mesh/efa.png")),
-                  std::shared_ptr<Surface>(rasterizer::loadPngSurface("../assets/mesh/f117.png"))
-              }) {
-            meshSurfaces = {
-                surfaces[0],
-                surfaces[1],
-                surfaces[2],
-                surfaces[3]
+        explicit Scene(const std::size_t residencyBudgetBytes = ResidencyManager::DEFAULT_BUDGET_BYTES)
+            : residency(residencyBudgetBytes) {
+            for (const auto* path : {
+                     "../assets/mesh/runway.obj",
+                     "../assets/mesh/f22.obj",
+                     "../assets/mesh/efa.obj",
+                     "../assets/mesh/f117.obj"
+                 }) {
+                residency.addMesh(path, VertexFormat::QUANTIZED16);
+            }
+
+            for (const auto* path : {
+                     "../assets/mesh/runway.png",
+                     "../assets/mesh/f22.png",
+                     "../assets/mesh/efa.png",
+                     "../assets/mesh/f117.png"
+                 }) {
+                residency.addSurface(path);
+            }
+
+            sceneInstances = {
+                {
+                    .mesh = 0, .surface = 0,
+                    .rotation = {0.0f, 0.0f, 0.0f},
+                    .translation = {0.0f, -1.5f, 23.0f}
+                },
+                {
+                    .mesh = 1, .surface = 1,
+                    .rotation = {0.0f, -std::numbers::pi / 2.0f, 0.0f},
+                    .translation = {0.0f, -1.3f, 5.0f}
+                },
+                {
+                    .mesh = 2, .surface = 2,
+                    .rotation = {0.0f, -std::numbers::pi / 2.0f, 0.0f},
+                    .translation = {-2.0f, -1.3f, 9.0f}
+                },
+                {
+                    .mesh = 3, .surface = 3,
+                    .rotation = {0.0f, -std::numbers::pi / 2.0f, 0.0f},
+                    .translation = {2.0f, -1.3f, 9.0f}
+                },
             };
+        }
 
-            meshes[0].translation = {0.0f, -1.5f, 23.0f};
-            meshes[1].translation = {0.0f, -1.3f, 5.0f};
-            meshes[2].translation = {-2.0f, -1.3f, 9.0f};
-            meshes[3].translation = {2.0f, -1.3f, 9.0f};
+        const std::vector<Instance>& instances() const {
+            return sceneInstances;
+        }
+
+        // Any access through this counts as a change to the scene
+        std::vector<Instance>& editInstances() {
+            instancesRevision++;
+            return sceneInstances;
+        }
 
-            meshes[0].rotation = {0.0f, 0.0f, 0.0f};
-            meshes[1].rotation = {0.0f, -std::numbers::pi / 2.0f, 0.0f};
-            meshes[2].rotation = {0.0f, -std::numbers::pi / 2.0f, 0.0f};
-            meshes[3].rotation = {0.0f, -std::numbers::pi / 2.0f, 0.0f};
+        // Changes whenever the instances may have changed
+        std::uint64_t revision() const {
+            return instancesRevision;
         }
 
         void lock() const {
-            for (const auto& surface : surfaces) {
-                surface->lock();
-            }
+            residency.lock();
         }
 
         void unlock() const {
-            for (const auto& surface : surfaces) {
-                surface->unlock();
-            }
+            residency.unlock();
         }
 
     private:
-        std::vector<std::shared_ptr<Surface>> surfaces;
+        std::vector<Instance> sceneInstances;
+        std::uint64_t instancesRevision = 0;
     };
 }
@@ -0,0 +1,261 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace rasterizer {
+    struct Simplification {
+        std::vector<std::uint32_t> faceIndices;
+        std::vector<std::uint32_t> uvIndices;
+        // Estimated distance to the source surface, in Model-space units
+        glm::float32_t error;
+    };
+
+    // Symmetric 4x4 matrix of an area weighted sum of squared point-plane distances, upper triangle only
+    // See: Garland & Heckbert, Surface Simplification Using Quadric Error Metrics
+    struct Quadric {
+        std::array<double, 10> q{};
+        double weight = 0.0;
+
+        static Quadric fromPlane(const glm::dvec3& normal, const double d, const double weight) {
+            const auto [a, b, c] = std::array{normal.x, normal.y, normal.z};
+            return {
+                .q = {
+                    weight * a * a, weight * a * b, weight * a * c, weight * a * d,
+                    weight * b * b, weight * b * c, weight * b * d,
+                    weight * c * c, weight * c * d,
+                    weight * d * d
+                },
+                .weight = weight
+            };
+        }
+
+        Quadric& operator+=(const Quadric& other) {
+            for (std::size_t i = 0; i < q.size(); ++i) {
+                q[i] += other.q[i];
+            }
+            weight += other.weight;
+            return *this;
+        }
+
+        // Weighted mean of the squared distances from p to the planes: [p 1]^T Q [p 1] / weight
+        double error(const glm::dvec3& p) const {
+            if (weight == 0.0) {
+                return 0.0;
+            }
+
+            return (q[0] * p.x * p.x + 2.0 * q[1] * p.x * p.y + 2.0 * q[2] * p.x * p.z + 2.0 * q[3] * p.x +
+                    q[4] * p.y * p.y + 2.0 * q[5] * p.y * p.z + 2.0 * q[6] * p.y +
+                    q[7] * p.z * p.z + 2.0 * q[8] * p.z +
+                    q[9]) / weight;
+        }
+    };
+
+    struct Collapse {
+        double cost;
+        std::uint32_t source, target;
+        std::uint32_t sourceVersion, targetVersion;
+
+        bool operator>(const Collapse& other) const {
+            return cost > other.cost;
+        }
+    };
+
+    /*
+     * Quadric error half-edge collapse simplification.
+     * Vertices are only ever merged into one another, so the resulting faces keep indexing the source vertices.
+     * Border and non-manifold vertices are never moved, which keeps open meshes from shrinking.
+     * Each face corner keeps its original uv index, texture coordinates slide slightly around collapsed vertices.
+     */
+    inline Simplification simplify(const std::vector<glm::vec3>& vertices,
+                                   const std::vector<std::uint32_t>& faceIndices,
+                                   const std::vector<std::uint32_t>& uvIndices,
+                                   const std::size_t targetFacesAmount) {
+        const std::size_t facesAmount = faceIndices.size() / 3;
+        const bool hasUvs = uvIndices.size() == faceIndices.size();
+
+        std::vector<std::array<std::uint32_t, 3>> faces(facesAmount);
+        std::vector<bool> isFaceRemoved(facesAmount, false);
+        std::vector<std::vector<std::uint32_t>> vertexFaces(vertices.size());
+        std::vector<Quadric> quadrics(vertices.size());
+
+        for (std::uint32_t face = 0; face < facesAmount; ++face) {
+            faces[face] = {faceIndices[3 * face], faceIndices[3 * face + 1], faceIndices[3 * face + 2]};
+
+            const glm::dvec3 v0{vertices[faces[face][0]]};
+            const glm::dvec3 v1{vertices[faces[face][1]]};
+            const glm::dvec3 v2{vertices[faces[face][2]]};
+            const auto normal = glm::cross(v1 - v0, v2 - v0);
+            const double length = glm::length(normal);
+
+            for (const auto vertex : faces[face]) {
+                vertexFaces[vertex].emplace_back(face);
+                if (length > 0.0) {
+                    // Length of the cross product is twice the face area
+                    quadrics[vertex] += Quadric::fromPlane(normal / length, -glm::dot(normal / length, v0),
+                                                           length / 2.0);
+                }
+            }
+        }
+
+        // Lock vertices of edges that do not have exactly two adjacent faces
+        std::vector<bool> isLocked(vertices.size(), false);
+        {
+            std::vector<std::pair<std::uint32_t, std::uint32_t>> edges;
+            edges.reserve(faceIndices.size());
+            for (const auto& face : faces) {
+                for (std::size_t e = 0; e < 3; ++e) {
+                    const auto a = face[e], b = face[(e + 1) % 3];
+                    edges.emplace_back(std::min(a, b), std::max(a, b));
+                }
+            }
+            std::ranges::sort(edges);
+
+            for (std::size_t i = 0; i < edges.size();) {
+                std::size_t j = i;
+                while (j < edges.size() && edges[j] == edges[i]) {
+                    ++j;
+                }
+                if (j - i != 2) {
+                    isLocked[edges[i].first] = true;
+                    isLocked[edges[i].second] = true;
+                }
+                i = j;
+            }
+        }
+
+        std::vector<std::uint32_t> versions(vertices.size(), 0);
+        std::priority_queue<Collapse, std::vector<Collapse>, std::greater<>> collapses;
+
+        const auto pushEdge = [&](const std::uint32_t a, const std::uint32_t b) {
+            auto combined = quadrics[a];
+            combined += quadrics[b];
+
+            // Collapse in whichever direction is allowed and cheaper
+            static constexpr double forbidden = std::numeric_limits<double>::max();
+            const double costAtB = isLocked[a] ? forbidden : combined.error(glm::dvec3{vertices[b]});
+            const double costAtA = isLocked[b] ? forbidden : combined.error(glm::dvec3{vertices[a]});
+            if (costAtB == forbidden && costAtA == forbidden) {
+                return;
+            }
+
+            if (costAtB <= costAtA) {
+                collapses.push({std::max(costAtB, 0.0), a, b, versions[a], versions[b]});
+            } else {
+                collapses.push({std::max(costAtA, 0.0), b, a, versions[b], versions[a]});
+            }
+        };
+
+        for (const auto& face : faces) {
+            for (std::size_t e = 0; e < 3; ++e) {
+                // Each interior edge is shared by two faces, only push it once
+                if (face[e] < face[(e + 1) % 3]) {
+                    pushEdge(face[e], face[(e + 1) % 3]);
+                }
+            }
+        }
+
+        const auto isCollapseValid = [&](const std::uint32_t source, const std::uint32_t target) {
+            for (const auto face : vertexFaces[source]) {
+                const auto& corners = faces[face];
+                if (isFaceRemoved[face] || std::ranges::find(corners, target) != corners.end()) {
+                    continue;
+                }
+
+                std::array<glm::vec3, 3> moved{vertices[corners[0]], vertices[corners[1]], vertices[corners[2]]};
+                const auto previousNormal = glm::cross(moved[1] - moved[0], moved[2] - moved[0]);
+                for (std::size_t c = 0; c < 3; ++c) {
+                    if (corners[c] == source) {
+                        moved[c] = vertices[target];
+                    }
+                }
+                const auto normal = glm::cross(moved[1] - moved[0], moved[2] - moved[0]);
+
+                // Reject degenerate and flipped (or nearly flipped) faces
+                const glm::float32_t lengths = glm::length(previousNormal) * glm::length(normal);
+                if (lengths == 0.0f || glm::dot(previousNormal, normal) < 0.2f * lengths) {
+                    return false;
+                }
+            }
+
+            return true;
+        };
+
+        std::size_t liveFacesAmount = facesAmount;
+        double maxCost = 0.0;
+
+        while (liveFacesAmount > targetFacesAmount && !collapses.empty()) {
+            const auto collapse = collapses.top();
+            collapses.pop();
+
+            const auto [cost, source, target, sourceVersion, targetVersion] = collapse;
+            if (sourceVersion != versions[source] || targetVersion != versions[target]) {
+                // Stale, a vertex changed since this collapse was evaluated
+                continue;
+            }
+
+            if (!isCollapseValid(source, target)) {
+                continue;
+            }
+
+            for (const auto face : vertexFaces[source]) {
+                if (isFaceRemoved[face]) {
+                    continue;
+                }
+
+                auto& corners = faces[face];
+                if (std::ranges::find(corners, target) != corners.end()) {
+                    isFaceRemoved[face] = true;
+                    liveFacesAmount--;
+                    continue;
+                }
+
+                std::ranges::replace(corners, source, target);
+                vertexFaces[target].emplace_back(face);
+            }
+            vertexFaces[source].clear();
+
+            quadrics[target] += quadrics[source];
+            versions[source]++;
+            versions[target]++;
+            maxCost = std::max(maxCost, cost);
+
+            // Re-evaluate every edge around the merged vertex
+            std::erase_if(vertexFaces[target], [&](const auto face) { return isFaceRemoved[face]; });
+            for (const auto face : vertexFaces[target]) {
+                for (const auto vertex : faces[face]) {
+                    if (vertex != target) {
+                        pushEdge(target, vertex);
+                    }
+                }
+            }
+        }
+
+        Simplification result{};
+        result.error = static_cast<glm::float32_t>(std::sqrt(maxCost));
+        result.faceIndices.reserve(3 * liveFacesAmount);
+        result.uvIndices.reserve(hasUvs ? 3 * liveFacesAmount : 0);
+        for (std::size_t face = 0; face < facesAmount; ++face) {
+            if (isFaceRemoved[face]) {
+                continue;
+            }
+
+            for (std::size_t c = 0; c < 3; ++c) {
+                result.faceIndices.emplace_back(faces[face][c]);
+                if (hasUvs) {
+                    result.uvIndices.emplace_back(uvIndices[3 * face + c]);
+                }
+            }
+        }
+
+        return result;
+    }
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+namespace rasterizer {
+    // Triangles per triangle setup path, over one frame
+    struct TriangleSetupCounters {
+        std::uint64_t zeroArea = 0;
+        std::uint64_t noSample = 0;
+        std::uint64_t micro = 0;
+        std::uint64_t regular = 0;
+    };
+
+    // Fragments depth tested, and written, by the raster stage
+    struct FragmentCounters {
+        std::uint64_t tested = 0;
+        std::uint64_t passed = 0;
+
+        FragmentCounters& operator+=(const FragmentCounters& other) {
+            tested += other.tested;
+            passed += other.passed;
+            return *this;
+        }
+    };
+
+    // The most recent CAPACITY samples, the oldest is overwritten first
+    class RollingSamples {
+    public:
+        static constexpr std::size_t CAPACITY = 256;
+
+        void add(const float sample) {
+            samples[next] = sample;
+            next = (next + 1) % CAPACITY;
+            samplesAmount = std::min(samplesAmount + 1, CAPACITY);
+        }
+
+        std::size_t size() const {
+            return samplesAmount;
+        }
+
+        // Most recent sample
+        float latest() const {
+            return samplesAmount > 0 ? samples[(next + CAPACITY - 1) % CAPACITY] : 0.0f;
+        }
+
+        float mean() const {
+            float sum = 0.0f;
+            for (std::size_t i = 0; i < samplesAmount; ++i) {
+                sum += samples[i];
+            }
+            return samplesAmount > 0 ? sum / static_cast<float>(samplesAmount) : 0.0f;
+        }
+
+        // Nearest rank, percentile in [0, 1]
+        float percentile(const float percentile) const {
+            if (samplesAmount == 0) {
+                return 0.0f;
+            }
+
+            std::array<float, CAPACITY> sorted;
+            std::copy_n(samples.begin(), samplesAmount, sorted.begin());
+            const auto rank = static_cast<std::size_t>(percentile * static_cast<float>(samplesAmount - 1) + 0.5f);
+            std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.begin() + samplesAmount);
+            return sorted[rank];
+        }
+
+        // Ring storage, oldest sample at offset() once full (the layout ImGui::PlotLines expects)
+        const float* data() const {
+            return samples.data();
+        }
+
+        std::size_t offset() const {
+            return samplesAmount == CAPACITY ? next : 0;
+        }
+
+    private:
+        std::array<float, CAPACITY> samples{};
+        std::size_t next = 0;
+        std::size_t samplesAmount = 0;
+    };
+}
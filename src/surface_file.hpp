@@ -0,0 +1,147 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <vector>
+
+#include <SDL2/SDL.h>
+
+#include "asset_file.hpp"
+#include "color.hpp"
+#include "mapped_file.hpp"
+#include "texture.hpp"
+
+namespace rasterizer {
+    static constexpr std::string_view SURFACE_FILE_EXTENSION = ".rsurf";
+
+    /*
+     * Decoded surface: SurfaceFileHeader, then the rows of pixels already in colorFormat, tightly packed.
+     * Mapped surfaces wrap the file pixels directly, skipping both the PNG decode and the format conversion.
+     * Surfaces have a single level, there is no mip chain to store.
+     */
+    struct SurfaceFileHeader {
+        static constexpr std::array<char, 8> MAGIC = {'R', 'S', 'U', 'R', 'F', '\0', '\0', '\0'};
+        // Bump on any change to the layout of the file
+        static constexpr std::uint32_t VERSION = 1;
+        static constexpr std::uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+        std::array<char, 8> magic;
+        std::uint32_t version;
+        std::uint32_t byteOrder;
+
+        AssetSource source;
+
+        std::uint32_t format;
+        std::uint32_t width;
+        std::uint32_t height;
+        std::uint32_t reserved;
+
+        std::uint64_t pixelsOffset;
+    };
+
+    static_assert(std::is_trivially_copyable_v<SurfaceFileHeader> && sizeof(SurfaceFileHeader) == 64);
+
+    inline std::vector<std::byte> serializeSurface(const AssetSource& source, const Surface& surface) {
+        const std::size_t rowBytes = surface.width * sizeof(color_t);
+        const std::size_t pixelsOffset = alignAssetSection(sizeof(SurfaceFileHeader));
+
+        const SurfaceFileHeader header{
+            .magic = SurfaceFileHeader::MAGIC,
+            .version = SurfaceFileHeader::VERSION,
+            .byteOrder = SurfaceFileHeader::BYTE_ORDER_MARK,
+            .source = source,
+            .format = colorFormat, .width = surface.width, .height = surface.height,
+            .reserved = 0,
+            .pixelsOffset = pixelsOffset
+        };
+
+        std::vector<std::byte> image(pixelsOffset + surface.height * rowBytes);
+        std::memcpy(image.data(), &header, sizeof(header));
+
+        // SDL rows may be padded
+        surface.lock();
+        const auto* pixels = static_cast<const std::byte*>(surface.surface->pixels);
+        for (std::uint32_t y = 0; y < surface.height; ++y) {
+            std::memcpy(image.data() + pixelsOffset + y * rowBytes, pixels + y * surface.surface->pitch, rowBytes);
+        }
+        surface.unlock();
+
+        return image;
+    }
+
+    // Maps a surface file, nullptr if it is missing, from another version or malformed
+    inline Surface* readSurfaceFile(const std::filesystem::path& surfacePath,
+                                    const std::filesystem::path& sourcePath) {
+        std::error_code error;
+        if (!std::filesystem::is_regular_file(surfacePath, error)) {
+            return nullptr;
+        }
+
+        std::shared_ptr<const MappedFile> file;
+        try {
+            file = std::make_shared<const MappedFile>(surfacePath, FileAccess::WHOLE);
+        } catch (const std::runtime_error&) {
+            return nullptr;
+        }
+
+        if (file->bytesAmount() < sizeof(SurfaceFileHeader)) {
+            return nullptr;
+        }
+        const auto& header = *reinterpret_cast<const SurfaceFileHeader*>(file->data());
+        const std::uint64_t pixelsBytes = static_cast<std::uint64_t>(header.width) * header.height * sizeof(color_t);
+        if (header.magic != SurfaceFileHeader::MAGIC || header.version != SurfaceFileHeader::VERSION
+            || header.byteOrder != SurfaceFileHeader::BYTE_ORDER_MARK || header.format != colorFormat
+            || header.pixelsOffset % alignof(color_t) != 0 || header.pixelsOffset > file->bytesAmount()
+            || pixelsBytes > file->bytesAmount() - header.pixelsOffset
+            || !isSourceUnchanged(header.source, sourcePath)) {
+            return nullptr;
+        }
+
+        // The surface only ever reads its pixels, SDL does not free preallocated pixels
+        SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormatFrom(
+            const_cast<std::byte*>(file->data() + header.pixelsOffset),
+            static_cast<int>(header.width), static_cast<int>(header.height),
+            sizeof(color_t) * 8, static_cast<int>(header.width * sizeof(color_t)), colorFormat
+        );
+        if (surface == nullptr) {
+            return nullptr;
+        }
+
+        return new Surface{
+            .width = header.width, .height = header.height,
+            .surface = std::unique_ptr<SDL_Surface, decltype(&SDL_FreeSurface)>(surface, SDL_FreeSurface),
+            .storage = std::move(file)
+        };
+    }
+
+    // Loads a PNG through the surface file next to it, which is (re)built from the PNG when missing or stale
+    inline Surface* loadSurface(const std::filesystem::path& pngPath) {
+        auto surfacePath = pngPath;
+        surfacePath.replace_extension(SURFACE_FILE_EXTENSION);
+
+        if (Surface* surface = readSurfaceFile(surfacePath, pngPath); surface != nullptr) {
+            return surface;
+        }
+
+        Surface* surface = loadPngSurface(pngPath);
+        if (surface == nullptr) {
+            return nullptr;
+        }
+
+        const MappedFile png(pngPath);
+        const auto image = serializeSurface(describeSource(pngPath, {png.data(), png.bytesAmount()}), *surface);
+        if (!writeAssetFile(surfacePath, image)) {
+            rasterizer::print("{}: could not write {}\n", pngPath.filename().string(), surfacePath.string());
+        }
+
+        return surface;
+    }
+}
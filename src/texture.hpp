@@ -12,6 +12,8 @@ namespace rasterizer {
     struct Surface {
         const std::uint32_t width, height;
         const std::unique_ptr<SDL_Surface, decltype(&SDL_FreeSurface)> surface;
+        // Owner of the pixels when the surface wraps memory it does not allocate, e.g. a mapped surface file
+        const std::shared_ptr<const void> storage = nullptr;
 
         void lock() const {
             if (SDL_LockSurface(surface.get()) != EXIT_SUCCESS) {
@@ -30,7 +32,7 @@ namespace rasterizer {
         }
     };
 
-    static Surface* loadPngSurface(const std::filesystem::path& path) {
+    inline Surface* loadPngSurface(const std::filesystem::path& path) {
         if (!std::filesystem::exists(path) || path.extension() != ".png") {
             rasterizer::print("File does not exist or is not .png: {}", path.string());
             return nullptr;
@@ -64,7 +66,7 @@ namespace rasterizer {
         };
     }
 
-    static Surface* loadDataSurface(const std::uint32_t* data, const std::uint32_t width, const std::uint32_t height) {
+    inline Surface* loadDataSurface(const std::uint32_t* data, const std::uint32_t width, const std::uint32_t height) {
         // Create an SDL_Surface from the data
         SDL_Surface* originalSurface = SDL_CreateRGBSurfaceWithFormatFrom(
             const_cast<std::uint32_t*>(data), width, height,
@@ -0,0 +1,274 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace rasterizer {
+    /*
+     * Fixed set of worker threads consuming a FIFO task queue.
+     * A pool without threads (single core, or WASM) runs every task inline on submit.
+     */
+    class ThreadPool {
+    public:
+        // initializeWorker, if any, runs first on every worker thread
+        explicit ThreadPool(const std::size_t threadsAmount, void (*initializeWorker)() = nullptr) {
+            for (std::size_t i = 0; i < threadsAmount; ++i) {
+                workers.emplace_back([this, initializeWorker] {
+                    if (initializeWorker != nullptr) {
+                        initializeWorker();
+                    }
+                    work();
+                });
+            }
+        }
+
+        ~ThreadPool() {
+            {
+                std::lock_guard lock(mutex);
+                isShuttingDown = true;
+            }
+            taskQueued.notify_all();
+
+            for (auto& worker : workers) {
+                worker.join();
+            }
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        // One thread per core, minus the calling thread
+        static std::size_t defaultThreadsAmount() {
+#ifdef __EMSCRIPTEN__
+            return 0;
+#else
+            return std::max(std::thread::hardware_concurrency(), 1u) - 1;
+#endif
+        }
+
+        std::size_t size() const {
+            return workers.size();
+        }
+
+        template<typename Function>
+        std::future<std::invoke_result_t<std::decay_t<Function>>> submit(Function&& function) {
+            using Result = std::invoke_result_t<std::decay_t<Function>>;
+
+            // std::function requires copyable targets, packaged_task is move-only
+            auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Function>(function));
+            auto future = task->get_future();
+
+            if (workers.empty()) {
+                (*task)();
+                return future;
+            }
+
+            {
+                std::lock_guard lock(mutex);
+                tasks.emplace_back([task] { (*task)(); });
+            }
+            taskQueued.notify_one();
+
+            return future;
+        }
+
+        /*
+         * Runs function(task) for every task in [0, tasksAmount) on the calling thread and whichever workers are idle,
+         * so it can be called from a worker of the same pool. Meant for coarse tasks, function must not throw.
+         */
+        template<typename Function>
+        void parallelFor(const std::size_t tasksAmount, const Function& function) {
+            struct Progress {
+                std::atomic<std::size_t> nextTask{0};
+                std::atomic<std::size_t> doneAmount{0};
+            };
+            // Helpers starting once every task is claimed only touch progress, which they keep alive
+            const auto progress = std::make_shared<Progress>();
+            const auto work = [progress, tasksAmount, function = &function] {
+                for (std::size_t task = progress->nextTask++; task < tasksAmount; task = progress->nextTask++) {
+                    (*function)(task);
+                    if (++progress->doneAmount == tasksAmount) {
+                        progress->doneAmount.notify_all();
+                    }
+                }
+            };
+
+            for (std::size_t i = 1; i < std::min(workers.size() + 1, tasksAmount); ++i) {
+                submit(work);
+            }
+            work();
+
+            for (std::size_t done = progress->doneAmount.load(); done < tasksAmount;
+                 done = progress->doneAmount.load()) {
+                progress->doneAmount.wait(done);
+            }
+        }
+
+        /*
+         * Runs produce(task, slot) for every task in [0, tasksAmount) on the workers and the calling thread,
+         * while consume(task, slot) is called on the calling thread strictly in task order as results become ready.
+         * At most slotsAmount tasks are in flight, so producers can write into slotsAmount preallocated outputs.
+         * Slot state is kept between calls and helpers are dispatched without allocating. produce must not throw.
+         */
+        template<typename Produce, typename Consume>
+        void parallelOrdered(const std::size_t tasksAmount, const std::size_t slotsAmount,
+                             const Produce& produce, const Consume& consume) {
+            reserveOrderedSlots(slotsAmount);
+            // Per slot, 1 + index of the last task produced into it
+            std::atomic<std::size_t>* produced = producedSlots.get();
+            for (std::size_t slot = 0; slot < slotsAmount; ++slot) {
+                produced[slot].store(0, std::memory_order_relaxed);
+            }
+
+            std::atomic<std::size_t> nextTask{0};
+            std::atomic<std::size_t> consumedAmount{0};
+
+            const auto claim = [&](const std::size_t limit) -> std::optional<std::size_t> {
+                std::size_t task = nextTask.load(std::memory_order_relaxed);
+                while (task < limit) {
+                    if (nextTask.compare_exchange_weak(task, task + 1, std::memory_order_relaxed)) {
+                        return task;
+                    }
+                }
+                return std::nullopt;
+            };
+
+            const auto run = [&](const std::size_t task) {
+                const std::size_t slot = task % slotsAmount;
+                produce(task, slot);
+                produced[slot].store(task + 1, std::memory_order_release);
+                produced[slot].notify_one();
+            };
+
+            const auto help = [&] {
+                while (const auto task = claim(tasksAmount)) {
+                    // Wait until the slot has been consumed
+                    std::size_t consumed = consumedAmount.load(std::memory_order_acquire);
+                    while (*task >= consumed + slotsAmount) {
+                        consumedAmount.wait(consumed, std::memory_order_acquire);
+                        consumed = consumedAmount.load(std::memory_order_acquire);
+                    }
+                    run(*task);
+                }
+            };
+            startSharedJob(std::min(workers.size(), tasksAmount), help);
+
+            for (std::size_t task = 0; task < tasksAmount; ++task) {
+                const std::size_t slot = task % slotsAmount;
+
+                // Help out instead of idling, as long as a slot is free
+                std::size_t ready = produced[slot].load(std::memory_order_acquire);
+                while (ready != task + 1) {
+                    if (const auto claimed = claim(std::min(tasksAmount, task + slotsAmount))) {
+                        run(*claimed);
+                    } else {
+                        produced[slot].wait(ready, std::memory_order_acquire);
+                    }
+                    ready = produced[slot].load(std::memory_order_acquire);
+                }
+
+                consume(task, slot);
+                consumedAmount.store(task + 1, std::memory_order_release);
+                consumedAmount.notify_all();
+            }
+
+            // help is on this stack frame
+            waitSharedJob();
+        }
+
+        // So that parallelOrdered with up to slotsAmount slots does not allocate
+        void reserveOrderedSlots(const std::size_t slotsAmount) {
+            if (slotsAmount > producedSlotsAmount) {
+                producedSlots = std::make_unique<std::atomic<std::size_t>[]>(slotsAmount);
+                producedSlotsAmount = slotsAmount;
+            }
+        }
+
+    private:
+        // Non-owning callable run by several workers at once
+        struct SharedJob {
+            void (*function)(const void*) = nullptr;
+            const void* context = nullptr;
+        };
+
+        std::mutex mutex;
+        std::condition_variable taskQueued;
+        std::deque<std::function<void()>> tasks;
+        bool isShuttingDown = false;
+
+        SharedJob sharedJob;
+        // Workers yet to start, and yet to finish, the shared job
+        std::size_t sharedJobStartsAmount = 0;
+        std::size_t sharedJobRunsAmount = 0;
+        std::condition_variable sharedJobDone;
+
+        std::unique_ptr<std::atomic<std::size_t>[]> producedSlots;
+        std::size_t producedSlotsAmount = 0;
+
+        std::vector<std::thread> workers;
+
+        // The function must outlive waitSharedJob()
+        template<typename Function>
+        void startSharedJob(const std::size_t workersAmount, const Function& function) {
+            if (workersAmount == 0) {
+                return;
+            }
+            {
+                std::lock_guard lock(mutex);
+                sharedJob = {[](const void* context) { (*static_cast<const Function*>(context))(); }, &function};
+                sharedJobStartsAmount = workersAmount;
+                sharedJobRunsAmount = workersAmount;
+            }
+            taskQueued.notify_all();
+        }
+
+        void waitSharedJob() {
+            std::unique_lock lock(mutex);
+            sharedJobDone.wait(lock, [this] { return sharedJobRunsAmount == 0; });
+        }
+
+        void work() {
+            while (true) {
+                std::function<void()> task;
+                SharedJob job;
+                {
+                    std::unique_lock lock(mutex);
+                    taskQueued.wait(lock, [this] {
+                        return isShuttingDown || sharedJobStartsAmount > 0 || !tasks.empty();
+                    });
+                    if (sharedJobStartsAmount > 0) {
+                        --sharedJobStartsAmount;
+                        job = sharedJob;
+                    } else if (isShuttingDown && tasks.empty()) {
+                        return;
+                    } else {
+                        task = std::move(tasks.front());
+                        tasks.pop_front();
+                    }
+                }
+
+                if (job.function != nullptr) {
+                    job.function(job.context);
+
+                    std::lock_guard lock(mutex);
+                    if (--sharedJobRunsAmount == 0) {
+                        sharedJobDone.notify_all();
+                    }
+                    continue;
+                }
+                task();
+            }
+        }
+    };
+}
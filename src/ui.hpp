@@ -2,6 +2,9 @@
 
 #include <filesystem>
 
+#include "profiler.hpp"
+#include "stats.hpp"
+
 #include "imgui.h"
 #include "backends/imgui_impl_sdl2.h"
 #include "backends/imgui_impl_sdlrenderer2.h"
@@ -45,7 +48,9 @@ namespace rasterizer::ui {
 
     void render(glm::vec3 frustumEye, glm::vec3 frustumForward, bool backfaceCullingEnabled,
                 bool isPointModeEnabled, bool isLineModeEnabled, bool isFillModeEnabled,
-                std::int32_t fillModeIndex, std::int32_t rasterizationRuleIndex) {
+                std::int32_t fillModeIndex, std::int32_t rasterizationRuleIndex,
+                const TriangleSetupCounters& setupCounters, const RollingSamples& inputLatency,
+                const Profiler& profiler) {
         // Set the position to (16, 16) from the top-left
         constexpr ImVec2 windowPos(16.0f, 16.0f);
         ImGui::SetNextWindowPos(windowPos, ImGuiCond_Always);
@@ -80,6 +85,42 @@ namespace rasterizer::ui {
                      &rasterizationRuleIndex, rasterizationRuleLabels.data(), rasterizationRuleLabels.size());
         ImGui::EndDisabled();
 
+        ImGui::SeparatorText("Triangle Setup");
+        ImGui::Text("Regular: %llu", static_cast<unsigned long long>(setupCounters.regular));
+        ImGui::Text("Micro: %llu", static_cast<unsigned long long>(setupCounters.micro));
+        ImGui::Text("Zero area: %llu", static_cast<unsigned long long>(setupCounters.zeroArea));
+        ImGui::Text("No sample: %llu", static_cast<unsigned long long>(setupCounters.noSample));
+
+        ImGui::SeparatorText("Input Latency");
+        // Event timestamp to present, over the last RollingSamples::CAPACITY input events
+        ImGui::Text("p50: %.1f ms", inputLatency.percentile(0.5f));
+        ImGui::Text("p99: %.1f ms", inputLatency.percentile(0.99f));
+
+        ImGui::SeparatorText("Pipeline");
+        const auto& counters = profiler.counters();
+        ImGui::Text("Triangles in: %llu", static_cast<unsigned long long>(counters.trianglesIn));
+        ImGui::Text("Culled: %llu", static_cast<unsigned long long>(counters.trianglesCulled));
+        ImGui::Text("Clipped: %llu", static_cast<unsigned long long>(counters.trianglesClipped));
+        ImGui::Text("Emitted: %llu", static_cast<unsigned long long>(counters.trianglesEmitted));
+        ImGui::Text("Fragments: %llu / %llu passed", static_cast<unsigned long long>(counters.fragments.passed),
+                    static_cast<unsigned long long>(counters.fragments.tested));
+        ImGui::Text("Overdraw: %.2fx", profiler.overdraw());
+
+        ImGui::SeparatorText("Profiler");
+        if (!profiler.isEnabled()) {
+            ImGui::TextDisabled("Press P to enable");
+        } else {
+            // Averages over the last RollingSamples::CAPACITY frames
+            const auto& frameTime = profiler.frameTime();
+            ImGui::Text("Frame: %.2f ms (p99 %.2f ms)", frameTime.mean(), frameTime.percentile(0.99f));
+            ImGui::PlotLines("##Frame time", frameTime.data(), static_cast<int>(frameTime.size()),
+                             static_cast<int>(frameTime.offset()), nullptr, 0.0f, FLT_MAX, ImVec2(0.0f, 48.0f));
+            for (std::size_t stage = 0; stage < STAGES_AMOUNT; ++stage) {
+                const auto& stageTime = profiler.stageTime(static_cast<Stage>(stage));
+                ImGui::Text("%-15s %6.2f ms", stageName(static_cast<Stage>(stage)), stageTime.mean());
+            }
+        }
+
         ImGui::SeparatorText("Controls");
         ImGui::Columns(2, "Controls Table", true);
         ImGui::SetColumnWidth(0, 144.0f);
@@ -108,6 +149,11 @@ namespace rasterizer::ui {
         ImGui::NextColumn();
         ImGui::Text("DDA / Top-Left rasterization");
         ImGui::NextColumn();
+        // Profiler
+        ImGui::Text("P");
+        ImGui::NextColumn();
+        ImGui::Text("Toggle the profiler");
+        ImGui::NextColumn();
         // Esc
         ImGui::Text("Esc");
         ImGui::NextColumn();
@@ -0,0 +1,200 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace rasterizer {
+    // Interleaved vertex attributes, a position is duplicated once per distinct uv it is used with
+    struct Vertex {
+        glm::vec3 position;
+        glm::vec2 uv;
+    };
+
+    enum class VertexFormat : std::uint32_t {
+        // 20 bytes per vertex, 32-bit indices
+        FLOAT32,
+        // 10 bytes per vertex, positions and uvs normalized to their bounding boxes,
+        // 16-bit indices when every vertex can be addressed with them
+        QUANTIZED16
+    };
+
+    struct QuantizedVertex {
+        std::array<std::uint16_t, 3> position;
+        std::array<std::uint16_t, 2> uv;
+    };
+
+    // Affine mapping from QuantizedVertex back to Vertex, value = offset + scale * quantized
+    struct VertexQuantization {
+        static constexpr glm::float32_t STEPS = std::numeric_limits<std::uint16_t>::max();
+
+        glm::vec3 positionOffset{0.0f};
+        glm::vec3 positionScale{1.0f};
+        glm::vec2 uvOffset{0.0f};
+        glm::vec2 uvScale{1.0f};
+
+        // Bounding boxes of the vertices to quantize
+        static VertexQuantization fit(const std::vector<Vertex>& vertices) {
+            glm::vec3 positionMin{std::numeric_limits<glm::float32_t>::max()};
+            glm::vec3 positionMax{std::numeric_limits<glm::float32_t>::lowest()};
+            glm::vec2 uvMin{std::numeric_limits<glm::float32_t>::max()};
+            glm::vec2 uvMax{std::numeric_limits<glm::float32_t>::lowest()};
+            for (const auto& vertex : vertices) {
+                positionMin = glm::min(positionMin, vertex.position);
+                positionMax = glm::max(positionMax, vertex.position);
+                uvMin = glm::min(uvMin, vertex.uv);
+                uvMax = glm::max(uvMax, vertex.uv);
+            }
+            if (vertices.empty()) {
+                return {};
+            }
+
+            return {
+                .positionOffset = positionMin, .positionScale = (positionMax - positionMin) / STEPS,
+                .uvOffset = uvMin, .uvScale = (uvMax - uvMin) / STEPS
+            };
+        }
+
+        // Model-space position of a quantized position, meant to be folded into the Model transformation
+        glm::mat4 positionTransformation() const {
+            return {
+                positionScale.x, 0.0f, 0.0f, 0.0f,
+                0.0f, positionScale.y, 0.0f, 0.0f,
+                0.0f, 0.0f, positionScale.z, 0.0f,
+                positionOffset.x, positionOffset.y, positionOffset.z, 1.0f
+            };
+        }
+
+        // Upper bound of the distance between a position and its quantized counterpart
+        glm::float32_t positionError() const {
+            return glm::length(positionScale) / 2.0f;
+        }
+
+        QuantizedVertex quantize(const Vertex& vertex) const {
+            const auto toSteps = [](const glm::float32_t value, const glm::float32_t offset,
+                                    const glm::float32_t scale) {
+                const glm::float32_t steps = scale > 0.0f ? std::round((value - offset) / scale) : 0.0f;
+                return static_cast<std::uint16_t>(std::clamp(steps, 0.0f, STEPS));
+            };
+
+            return {
+                .position = {
+                    toSteps(vertex.position.x, positionOffset.x, positionScale.x),
+                    toSteps(vertex.position.y, positionOffset.y, positionScale.y),
+                    toSteps(vertex.position.z, positionOffset.z, positionScale.z)
+                },
+                .uv = {toSteps(vertex.uv.x, uvOffset.x, uvScale.x), toSteps(vertex.uv.y, uvOffset.y, uvScale.y)}
+            };
+        }
+
+        glm::vec2 dequantizeUv(const QuantizedVertex& vertex) const {
+            return uvOffset + uvScale * glm::vec2(vertex.uv[0], vertex.uv[1]);
+        }
+
+        Vertex dequantize(const QuantizedVertex& vertex) const {
+            return {
+                .position = positionOffset + positionScale * glm::vec3(
+                    vertex.position[0], vertex.position[1], vertex.position[2]
+                ),
+                .uv = dequantizeUv(vertex)
+            };
+        }
+    };
+
+    // Index buffer stored with either 16 or 32 bits per index
+    class IndexSpan {
+    public:
+        IndexSpan() = default;
+
+        IndexSpan(const std::span<const std::uint32_t> indices)
+            : indices(indices.data()), amount(indices.size()), isShort(false) {
+        }
+
+        IndexSpan(const std::span<const std::uint16_t> indices)
+            : indices(indices.data()), amount(indices.size()), isShort(true) {
+        }
+
+        std::size_t size() const {
+            return amount;
+        }
+
+        bool empty() const {
+            return amount == 0;
+        }
+
+        // The width never changes within a mesh, the branch is always predicted
+        std::uint32_t operator[](const std::size_t index) const {
+            return isShort ? static_cast<const std::uint16_t*>(indices)[index]
+                           : static_cast<const std::uint32_t*>(indices)[index];
+        }
+
+    private:
+        const void* indices = nullptr;
+        std::size_t amount = 0;
+        bool isShort = false;
+    };
+
+    /*
+     * Deduplicates (position, uv) index pairs into a single vertex array.
+     * The same welder can be fed several index buffers over the same source attributes (e.g. levels of detail),
+     * in which case they end up sharing their vertices.
+     */
+    class VertexWelder {
+    public:
+        // Marks face corners that have no uv
+        static constexpr std::uint32_t NO_UV = std::numeric_limits<std::uint32_t>::max();
+
+        std::vector<Vertex> vertices;
+        // Source position index of every welded vertex, vertices split along uv seams share it
+        std::vector<std::uint32_t> positionIndices;
+
+        VertexWelder(const std::vector<glm::vec3>& positions, const std::vector<glm::vec2>& uvs)
+            : positions(positions), uvs(uvs) {
+            vertices.reserve(positions.size());
+            positionIndices.reserve(positions.size());
+            weldedIndices.reserve(positions.size());
+        }
+
+        // Returns one index into vertices per face corner
+        std::vector<std::uint32_t> weld(const std::vector<std::uint32_t>& faceIndices,
+                                        const std::vector<std::uint32_t>& uvIndices) {
+            // TODO: Allow for per-vertex optional uv texturing, right now uvs are either on every corner or none
+            const bool hasUvs = uvIndices.size() == faceIndices.size();
+
+            std::vector<std::uint32_t> indices;
+            indices.reserve(faceIndices.size());
+            for (std::size_t i = 0; i < faceIndices.size(); ++i) {
+                const std::uint32_t position = faceIndices[i];
+                const std::uint32_t uv = hasUvs ? uvIndices[i] : NO_UV;
+
+                const auto key = static_cast<std::uint64_t>(position) << 32 | uv;
+                const auto [welded, isNew] = weldedIndices.try_emplace(
+                    key, static_cast<std::uint32_t>(vertices.size()));
+                if (isNew) {
+                    vertices.emplace_back(Vertex{
+                        .position = positions[position],
+                        .uv = uv == NO_UV ? glm::vec2{0.0f} : uvs[uv]
+                    });
+                    positionIndices.emplace_back(position);
+                }
+                indices.emplace_back(welded->second);
+            }
+
+            return indices;
+        }
+
+    private:
+        const std::vector<glm::vec3>& positions;
+        const std::vector<glm::vec2>& uvs;
+
+        // (position index << 32 | uv index) -> index into vertices
+        std::unordered_map<std::uint64_t, std::uint32_t> weldedIndices;
+    };
+}
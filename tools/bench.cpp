@@ -0,0 +1,283 @@
+#define SDL_MAIN_HANDLED
+#include <SDL2/SDL.h>
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <numbers>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "common.hpp"
+#include "app.hpp"
+
+/*
+ * Renders the scene headless along scripted camera paths, at every resolution, fill mode and rasterization rule,
+ * and writes frame and stage times in milliseconds as JSON (bench.json by default). Run from bin/.
+ */
+namespace {
+    struct CameraPose {
+        glm::vec3 eye;
+        glm::float32_t yaw, pitch;
+    };
+
+    // Inverse of Application::update(), forward = rotateY(yaw) * rotateX(pitch) * +Z
+    CameraPose lookAt(const glm::vec3& eye, const glm::vec3& target) {
+        const glm::vec3 direction = glm::normalize(target - eye);
+        return {.eye = eye, .yaw = std::atan2(direction.x, direction.z), .pitch = -std::asin(direction.y)};
+    }
+
+    struct CameraPath {
+        const char* name;
+        // Progress in [0, 1)
+        CameraPose (*pose)(glm::float32_t progress);
+    };
+
+    constexpr glm::float32_t TAU = 2.0f * std::numbers::pi_v<glm::float32_t>;
+
+    // Poses are picked for the default Scene: a runway with three jets parked at its start
+    constexpr std::array<CameraPath, 3> cameraPaths{
+        CameraPath{
+            "orbit", [](const glm::float32_t progress) {
+                // Every jet in view, from every side
+                const glm::vec3 center{0.0f, -1.3f, 9.0f};
+                const glm::float32_t angle = TAU * progress;
+                return lookAt(center + glm::vec3{10.0f * std::sin(angle), 2.8f, -10.0f * std::cos(angle)}, center);
+            }
+        },
+        CameraPath{
+            "fly-through", [](const glm::float32_t progress) {
+                // Low over the jets, then along the runway
+                const glm::vec3 eye{0.0f, -0.3f, -6.0f + 36.0f * progress};
+                return lookAt(eye, eye + glm::vec3{0.0f, -0.1f, 1.0f});
+            }
+        },
+        CameraPath{
+            "close-up", [](const glm::float32_t progress) {
+                // Few, large triangles covering the whole canvas
+                const glm::vec3 jet{0.0f, -1.3f, 5.0f};
+                const glm::float32_t angle = TAU / 3.0f * (progress - 0.5f);
+                return lookAt(jet + glm::vec3{1.5f * std::sin(angle), 0.5f, -1.5f * std::cos(angle)}, jet);
+            }
+        },
+    };
+
+    struct Resolution {
+        std::uint32_t width, height;
+    };
+
+    struct Options {
+        std::uint64_t framesAmount = 300;
+        // Per run, not measured: assets load and caches warm up
+        std::uint64_t warmupFramesAmount = 30;
+        std::vector<Resolution> resolutions;
+        std::string output = "bench.json";
+    };
+
+    constexpr std::string_view USAGE =
+        "Usage: rasterizer-bench [--frames N] [--warmup N] [--size WIDTHxHEIGHT]... [--output FILE]";
+
+    template<typename T>
+    std::optional<T> parseUnsigned(const std::string_view text) {
+        T value = 0;
+        const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+        if (error != std::errc{} || end != text.data() + text.size()) {
+            return std::nullopt;
+        }
+        return value;
+    }
+
+    std::uint64_t parseCount(const std::string_view argument, const std::string_view value) {
+        const auto count = parseUnsigned<std::uint64_t>(value);
+        if (!count) {
+            throw std::runtime_error(std::format("Invalid {}, expected a count: {}\n{}", argument, value, USAGE));
+        }
+        return *count;
+    }
+
+    Options parseOptions(const int argc, char* argv[]) {
+        Options options;
+        // Every option takes a value
+        for (int i = 1; i < argc; i += 2) {
+            const std::string_view argument = argv[i];
+            if (i + 1 == argc) {
+                throw std::runtime_error(std::format("Missing value for {}\n{}", argument, USAGE));
+            }
+            const std::string_view value = argv[i + 1];
+            if (argument == "--frames") {
+                options.framesAmount = std::max<std::uint64_t>(parseCount(argument, value), 1);
+            } else if (argument == "--warmup") {
+                options.warmupFramesAmount = parseCount(argument, value);
+            } else if (argument == "--size") {
+                const auto separator = value.find('x');
+                const auto width = parseUnsigned<std::uint32_t>(value.substr(0, separator));
+                const auto height = separator == std::string_view::npos
+                                        ? std::nullopt
+                                        : parseUnsigned<std::uint32_t>(value.substr(separator + 1));
+                if (!width || !height || *width == 0 || *height == 0) {
+                    throw std::runtime_error(std::format("Invalid --size, expected WIDTHxHEIGHT: {}\n{}",
+                                                         value, USAGE));
+                }
+                options.resolutions.push_back({*width, *height});
+            } else if (argument == "--output") {
+                options.output = value;
+            } else {
+                throw std::runtime_error(std::format("Unknown option: {}\n{}", argument, USAGE));
+            }
+        }
+        if (options.resolutions.empty()) {
+            options.resolutions = {{640, 360}, {1280, 720}, {1920, 1080}};
+        }
+
+        return options;
+    }
+
+    const char* fillModeName(const rasterizer::FillMode mode) {
+        return mode == rasterizer::FillMode::TEXTURE ? "texture" : "vertex-color";
+    }
+
+    const char* rasterizationRuleName(const rasterizer::RasterizationRule rule) {
+        return rule == rasterizer::RasterizationRule::TOP_LEFT ? "top-left" : "dda";
+    }
+
+    // Nearest rank, as RollingSamples, over every measured frame
+    float percentile(const std::vector<float>& sorted, const float percentile) {
+        const auto rank = static_cast<std::size_t>(percentile * static_cast<float>(sorted.size() - 1) + 0.5f);
+        return sorted[rank];
+    }
+
+    float mean(const std::vector<float>& samples) {
+        double sum = 0.0;
+        for (const float sample : samples) {
+            sum += sample;
+        }
+        return static_cast<float>(sum / static_cast<double>(samples.size()));
+    }
+
+    struct RunResult {
+        std::vector<float> frameTimes;
+        std::array<std::vector<float>, rasterizer::STAGES_AMOUNT> stageTimes;
+        std::vector<float> trianglesEmitted;
+        std::vector<float> overdraw;
+    };
+
+    RunResult run(rasterizer::Application& app, const CameraPath& path, const Options& options) {
+        using Clock = std::chrono::steady_clock;
+        const auto& profiler = app.frameProfiler();
+
+        RunResult result;
+        const std::uint64_t totalFramesAmount = options.warmupFramesAmount + options.framesAmount;
+        for (std::uint64_t frame = 0; frame < totalFramesAmount; ++frame) {
+            const bool isMeasured = frame >= options.warmupFramesAmount;
+            // Warmup stays on the first pose
+            const std::uint64_t step = isMeasured ? frame - options.warmupFramesAmount : 0;
+            const auto [eye, yaw, pitch] = path.pose(static_cast<glm::float32_t>(step) /
+                                                     static_cast<glm::float32_t>(options.framesAmount));
+            app.moveCamera(eye, yaw, pitch);
+
+            const auto start = Clock::now();
+            app.update(0.0f);
+            app.render();
+            const auto frameTime = std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+
+            if (!isMeasured) {
+                continue;
+            }
+            result.frameTimes.push_back(frameTime);
+            for (std::size_t stage = 0; stage < rasterizer::STAGES_AMOUNT; ++stage) {
+                result.stageTimes[stage].push_back(profiler.stageTime(static_cast<rasterizer::Stage>(stage)).latest());
+            }
+            result.trianglesEmitted.push_back(static_cast<float>(profiler.counters().trianglesEmitted));
+            result.overdraw.push_back(profiler.overdraw());
+        }
+
+        return result;
+    }
+
+    void printRun(std::ostream& out, const CameraPath& path, const Resolution& resolution,
+                  const rasterizer::FillMode fillMode, const rasterizer::RasterizationRule rule,
+                  RunResult& result) {
+        auto& frameTimes = result.frameTimes;
+        const float frameTimeMean = mean(frameTimes);
+        std::ranges::sort(frameTimes);
+
+        rasterizer::print(out, "    {{\n");
+        rasterizer::print(out, "      \"path\": \"{}\", \"width\": {}, \"height\": {}, "
+                               "\"fillMode\": \"{}\", \"rasterizationRule\": \"{}\",\n",
+                          path.name, resolution.width, resolution.height,
+                          fillModeName(fillMode), rasterizationRuleName(rule));
+        rasterizer::print(out, "      \"frameTime\": {{\"min\": {:.3f}, \"mean\": {:.3f}, \"p50\": {:.3f}, "
+                               "\"p99\": {:.3f}}},\n",
+                          frameTimes.front(), frameTimeMean, percentile(frameTimes, 0.5f),
+                          percentile(frameTimes, 0.99f));
+        rasterizer::print(out, "      \"stages\": {{");
+        for (std::size_t stage = 0; stage < rasterizer::STAGES_AMOUNT; ++stage) {
+            rasterizer::print(out, "{}\"{}\": {:.3f}", stage == 0 ? "" : ", ",
+                              rasterizer::stageName(static_cast<rasterizer::Stage>(stage)),
+                              mean(result.stageTimes[stage]));
+        }
+        rasterizer::print(out, "}},\n");
+        rasterizer::print(out, "      \"trianglesEmitted\": {:.0f}, \"overdraw\": {:.3f}\n",
+                          mean(result.trianglesEmitted), mean(result.overdraw));
+        rasterizer::print(out, "    }}");
+    }
+}
+
+int main(int argc, char* argv[]) try {
+    const Options options = parseOptions(argc, argv);
+
+    std::ofstream out(options.output, std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Failed to open benchmark output: " + options.output);
+    }
+
+    static constexpr std::array fillModes{rasterizer::FillMode::VERTEX_COLOR, rasterizer::FillMode::TEXTURE};
+    static constexpr std::array rasterizationRules{
+        rasterizer::RasterizationRule::DDA, rasterizer::RasterizationRule::TOP_LEFT
+    };
+
+    rasterizer::print(out, "{{\n  \"frames\": {}, \"warmup\": {},\n  \"runs\": [\n",
+                      options.framesAmount, options.warmupFramesAmount);
+    bool isFirstRun = true;
+    for (const auto& resolution : options.resolutions) {
+        // The canvas size is fixed for the lifetime of an application
+        rasterizer::Application app(rasterizer::HeadlessOptions{
+            .width = resolution.width, .height = resolution.height, .isProfiling = true
+        });
+
+        for (const auto fillMode : fillModes) {
+            for (const auto rule : rasterizationRules) {
+                app.setRenderMode(fillMode, rule);
+
+                for (const auto& path : cameraPaths) {
+                    rasterizer::print(std::cerr, "{} {}x{} {} {}\n", path.name, resolution.width, resolution.height,
+                                      fillModeName(fillMode), rasterizationRuleName(rule));
+                    auto result = run(app, path, options);
+
+                    rasterizer::print(out, "{}", isFirstRun ? "" : ",\n");
+                    printRun(out, path, resolution, fillMode, rule, result);
+                    isFirstRun = false;
+                }
+            }
+        }
+    }
+    rasterizer::print(out, "\n  ]\n}}\n");
+    if (!out.good()) {
+        throw std::runtime_error("Failed to write benchmark output: " + options.output);
+    }
+    rasterizer::print(std::cerr, "Written to {}\n", options.output);
+
+    return EXIT_SUCCESS;
+} catch (const std::exception& e) {
+    rasterizer::print(std::cerr, "Exiting due to: {}\n", e.what());
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,105 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "common.hpp"
+#include "frame_ring.hpp"
+
+/*
+ * Reads the frames shared by `rasterizer --headless --shared-memory NAME` and reports throughput and latency.
+ * Usage: rasterizer-frame-consumer NAME [--dump FILE], FILE receives the raw pixels of the last frame
+ */
+int main(int argc, char* argv[]) try {
+    if (argc < 2) {
+        rasterizer::print("Usage: {} NAME [--dump FILE]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    const std::string_view nameArgument = argv[1];
+    // POSIX shared memory object names start with a slash
+    const std::string name = nameArgument.starts_with('/') ? std::string(nameArgument)
+                                                           : "/" + std::string(nameArgument);
+    std::optional<std::string> dumpPath;
+    for (int i = 2; i + 1 < argc; ++i) {
+        if (std::string_view(argv[i]) == "--dump") {
+            dumpPath = argv[i + 1];
+        }
+    }
+
+    rasterizer::print("Waiting for {}\n", name);
+    auto ring = [&] {
+        while (true) {
+            if (auto opened = rasterizer::FrameRing::open(name)) {
+                return std::move(*opened);
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }();
+
+    const auto& header = ring.header();
+    rasterizer::print("{}x{}, pixel format 0x{:08X}, {} slots\n",
+                      header.width, header.height, header.pixelFormat, header.slotsAmount);
+
+    using Clock = std::chrono::steady_clock;
+    const auto nanoseconds = [] {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+    };
+
+    std::uint64_t framesAmount = 0, intervalFramesAmount = 0;
+    std::int64_t intervalLatency = 0, maxLatency = 0;
+    std::uint64_t checksum = 0;
+    auto intervalStart = Clock::now();
+    // Written once the ring is closed, so that file access is not counted in the throughput
+    std::vector<std::uint32_t> lastFrame;
+
+    while (const auto frame = ring.acquireFrame()) {
+        const std::int64_t latency = nanoseconds() - frame->slot.timestamp;
+        intervalLatency += latency;
+        maxLatency = std::max(maxLatency, latency);
+
+        // Touches every pixel, as an encoder would
+        for (const std::uint32_t pixel : frame->pixels) {
+            checksum = checksum * 31 + pixel;
+        }
+        if (dumpPath) {
+            lastFrame.assign(frame->pixels.begin(), frame->pixels.end());
+        }
+        ring.releaseFrame();
+
+        framesAmount++;
+        intervalFramesAmount++;
+        if (const auto elapsed = Clock::now() - intervalStart; elapsed >= std::chrono::seconds(1)) {
+            const auto seconds = std::chrono::duration<double>(elapsed).count();
+            rasterizer::print("frame {}: {:.1f} FPS, latency {:.3f} ms mean, {:.3f} ms max\n",
+                              frame->slot.frame, static_cast<double>(intervalFramesAmount) / seconds,
+                              static_cast<double>(intervalLatency) / intervalFramesAmount / 1e6,
+                              static_cast<double>(maxLatency) / 1e6);
+            intervalFramesAmount = 0;
+            intervalLatency = 0;
+            maxLatency = 0;
+            intervalStart = Clock::now();
+        }
+    }
+
+    rasterizer::print("{} frames, checksum {:016X}\n", framesAmount, checksum);
+    if (dumpPath && !lastFrame.empty()) {
+        std::ofstream file(*dumpPath, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(lastFrame.data()),
+                   static_cast<std::streamsize>(lastFrame.size() * sizeof(std::uint32_t)));
+        if (!file) {
+            throw std::runtime_error("Failed to write " + *dumpPath);
+        }
+    }
+    return EXIT_SUCCESS;
+} catch (const std::exception& e) {
+    rasterizer::print("Exiting due to: {}\n", e.what());
+    return EXIT_FAILURE;
+}
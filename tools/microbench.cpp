@@ -0,0 +1,650 @@
+#define SDL_MAIN_HANDLED
+#include <SDL2/SDL.h>
+
+#include <algorithm>
+#include <atomic>
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <numbers>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "common.hpp"
+#include "canvas.hpp"
+#include "color.hpp"
+#include "frustum.hpp"
+#include "instance.hpp"
+#include "obj.hpp"
+#include "texture.hpp"
+
+/*
+ * Times the hot functions of the rasterizer on seeded synthetic inputs, in nanoseconds per operation.
+ * --filter only runs the benchmarks whose name contains TEXT, e.g. --filter drawTriangleDDA/large
+ */
+namespace rasterizer {
+    // Befriended by Canvas, forwards to its private kernels
+    struct CanvasKernels {
+        using VertexColorShader = Canvas::VertexColorShader;
+        using TextureShader = Canvas::TextureShader;
+
+        template<typename ColorShader>
+        static void drawTriangleTopLeft(const Canvas& canvas, const glm::vec4& v0, const glm::vec4& v1,
+                                        const glm::vec4& v2, const ColorShader& shader, FragmentCounters& fragments) {
+            canvas.drawTriangleTopLeft(v0, v1, v2, shader, canvas.allRows(), fragments);
+        }
+
+        template<typename ColorShader>
+        static void drawTriangleDDA(const Canvas& canvas, const glm::vec4& v0, const glm::vec4& v1,
+                                    const glm::vec4& v2, const glm::ivec2& p0, const glm::ivec2& p1,
+                                    const glm::ivec2& p2, const ColorShader& shader, FragmentCounters& fragments) {
+            canvas.drawTriangleDDA(v0, v1, v2, p0, p1, p2, shader, canvas.allRows(), fragments);
+        }
+
+        static void sortAscendingVertically(glm::vec4& v0, glm::vec4& v1, glm::vec4& v2,
+                                            glm::ivec2& p0, glm::ivec2& p1, glm::ivec2& p2,
+                                            glm::vec2& uv0, glm::vec2& uv1, glm::vec2& uv2) {
+            Canvas::sortAscendingVertically(v0, v1, v2, p0, p1, p2, uv0, uv1, uv2);
+        }
+
+        static glm::vec3 barycentricWeights(const glm::ivec2& a, const glm::ivec2& b, const glm::ivec2& c,
+                                            const glm::ivec2& p) {
+            return Canvas::barycentricWeights(a, b, c, p);
+        }
+
+        static color_t textureColoring(const glm::vec4& v0, const glm::vec4& v1, const glm::vec4& v2,
+                                       const glm::vec2& uv0, const glm::vec2& uv1, const glm::vec2& uv2,
+                                       const glm::vec3& weights, const glm::float32_t& wReciprocal,
+                                       const Surface* surface) {
+            return Canvas::textureColoring(v0, v1, v2, uv0, uv1, uv2, weights, wReciprocal, surface);
+        }
+
+        static glm::float32_t edgeCross(const glm::vec2& a, const glm::vec2& b, const glm::vec2& p) {
+            return Canvas::edgeCross(a, b, p);
+        }
+    };
+}
+
+namespace {
+    using rasterizer::CanvasKernels;
+
+    struct Options {
+        std::size_t repetitions = 15;
+        std::size_t warmupRepetitions = 3;
+        std::string filter;
+
+        bool isSelected(const std::string_view name) const {
+            return filter.empty() || name.find(filter) != std::string_view::npos;
+        }
+    };
+
+    constexpr std::string_view USAGE = "Usage: rasterizer-microbench [--repetitions N] [--warmup N] [--filter TEXT]";
+
+    std::size_t parseCount(const std::string_view argument, const std::string_view value) {
+        std::size_t count = 0;
+        const auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), count);
+        if (error != std::errc{} || end != value.data() + value.size()) {
+            throw std::runtime_error(std::format("Invalid {}, expected a count: {}\n{}", argument, value, USAGE));
+        }
+        return count;
+    }
+
+    Options parseOptions(const int argc, char* argv[]) {
+        Options options;
+        // Every option takes a value
+        for (int i = 1; i < argc; i += 2) {
+            const std::string_view argument = argv[i];
+            if (i + 1 == argc) {
+                throw std::runtime_error(std::format("Missing value for {}\n{}", argument, USAGE));
+            }
+            const std::string_view value = argv[i + 1];
+            if (argument == "--repetitions") {
+                options.repetitions = std::max<std::size_t>(parseCount(argument, value), 1);
+            } else if (argument == "--warmup") {
+                options.warmupRepetitions = parseCount(argument, value);
+            } else if (argument == "--filter") {
+                options.filter = value;
+            } else {
+                throw std::runtime_error(std::format("Unknown option: {}\n{}", argument, USAGE));
+            }
+        }
+
+        return options;
+    }
+
+    // Results are written here so that the compiler cannot discard the work that produced them
+    volatile std::uint64_t sink = 0;
+
+    template<typename T>
+    void keep(const T& value) {
+        std::uint64_t bits = 0;
+        std::memcpy(&bits, &value, std::min(sizeof(T), sizeof(bits)));
+        sink = sink + bits;
+    }
+
+    // As far as the compiler knows every input may have changed
+    void clobberMemory() {
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+    }
+
+    // Times repetitions of run, prepare runs untimed before each of them
+    void measure(const Options& options, const std::string& name, const std::size_t operationsAmount,
+                 const std::function<void()>& prepare, const std::function<void()>& run) {
+        using Clock = std::chrono::steady_clock;
+
+        for (std::size_t r = 0; r < options.warmupRepetitions; ++r) {
+            prepare();
+            clobberMemory();
+            run();
+        }
+
+        // Nanoseconds per operation
+        std::vector<double> samples;
+        samples.reserve(options.repetitions);
+        for (std::size_t r = 0; r < options.repetitions; ++r) {
+            prepare();
+            clobberMemory();
+            const auto start = Clock::now();
+            run();
+            clobberMemory();
+            const auto elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+            samples.push_back(elapsed / static_cast<double>(operationsAmount));
+        }
+
+        std::ranges::sort(samples);
+        double sum = 0.0;
+        for (const double sample : samples) {
+            sum += sample;
+        }
+        const double mean = sum / static_cast<double>(samples.size());
+        double squaredDeviations = 0.0;
+        for (const double sample : samples) {
+            squaredDeviations += (sample - mean) * (sample - mean);
+        }
+        const double deviation = std::sqrt(squaredDeviations / static_cast<double>(samples.size()));
+        const std::size_t middle = samples.size() / 2;
+        const double median = samples.size() % 2 == 1 ? samples[middle]
+                                                       : (samples[middle - 1] + samples[middle]) / 2.0;
+
+        rasterizer::print("{:<42} {:>8} {:>12.2f} {:>12.2f} {:>12.2f} {:>7.1f}%\n",
+                          name, operationsAmount, samples.front(), median, mean, 100.0 * deviation / mean);
+    }
+
+    void measure(const Options& options, const std::string& name, const std::size_t operationsAmount,
+                 const std::function<void()>& run) {
+        measure(options, name, operationsAmount, [] {}, run);
+    }
+
+    // Fixed seed, inputs are identical between runs and versions
+    std::mt19937 createRandom() {
+        return std::mt19937(0x5EED);
+    }
+
+    float uniform(std::mt19937& random, const float min, const float max) {
+        return std::uniform_real_distribution<float>(min, max)(random);
+    }
+
+    std::unique_ptr<rasterizer::Surface> createSurface(const std::uint32_t size, std::mt19937& random) {
+        std::vector<std::uint32_t> pixels(static_cast<std::size_t>(size) * size);
+        for (auto& pixel : pixels) {
+            pixel = static_cast<std::uint32_t>(random());
+        }
+
+        // The surface is converted into its own pixels, the source does not need to outlive it
+        std::unique_ptr<rasterizer::Surface> surface(rasterizer::loadDataSurface(pixels.data(), size, size));
+        if (surface == nullptr) {
+            throw std::runtime_error(std::format("Failed to create a {}x{} surface", size, size));
+        }
+
+        return surface;
+    }
+
+    // Random barycentric weights, summing to 1
+    glm::vec3 randomWeights(std::mt19937& random) {
+        const float alpha = uniform(random, 0.0f, 1.0f);
+        const float beta = uniform(random, 0.0f, 1.0f - alpha);
+        return {alpha, beta, 1.0f - alpha - beta};
+    }
+
+    // Screen-space triangles with an edge length drawn log-uniformly between minSize and maxSize pixels
+    struct TriangleDistribution {
+        const char* name;
+        float minSize, maxSize;
+    };
+
+    constexpr std::array<TriangleDistribution, 5> triangleDistributions{
+        TriangleDistribution{"tiny", 1.0f, 3.0f},
+        TriangleDistribution{"small", 4.0f, 12.0f},
+        TriangleDistribution{"medium", 16.0f, 48.0f},
+        TriangleDistribution{"large", 128.0f, 384.0f},
+        // Closest to a real scene
+        TriangleDistribution{"mixed", 1.0f, 384.0f},
+    };
+
+    constexpr std::uint32_t CANVAS_WIDTH = 1280, CANVAS_HEIGHT = 720;
+
+    std::vector<rasterizer::Triangle> createTriangles(const TriangleDistribution& distribution,
+                                                      const rasterizer::Surface* surface) {
+        // About the same amount of pixels per repetition, whatever the size of the triangles
+        static constexpr float PIXELS_PER_REPETITION = 4.0f * 1024.0f * 1024.0f;
+        const float typicalSize = std::sqrt(distribution.minSize * distribution.maxSize);
+        const auto trianglesAmount = static_cast<std::size_t>(
+            std::clamp(PIXELS_PER_REPETITION / (typicalSize * typicalSize / 4.0f), 256.0f, 65536.0f));
+
+        auto random = createRandom();
+        std::vector<rasterizer::Triangle> triangles;
+        triangles.reserve(trianglesAmount);
+        while (triangles.size() < trianglesAmount) {
+            const glm::vec2 center{uniform(random, 0.0f, CANVAS_WIDTH), uniform(random, 0.0f, CANVAS_HEIGHT)};
+            const float size = std::exp(uniform(random, std::log(distribution.minSize),
+                                                std::log(distribution.maxSize)));
+
+            std::array<glm::vec4, 3> vertices;
+            for (auto& vertex : vertices) {
+                // w is the View-space depth, z is unused past projection
+                vertex = {
+                    center.x + size * uniform(random, -0.5f, 0.5f), center.y + size * uniform(random, -0.5f, 0.5f),
+                    0.5f, uniform(random, 1.0f, 50.0f)
+                };
+            }
+            // Top-left only fills counter-clockwise triangles, DDA fills either winding
+            const float area = CanvasKernels::edgeCross(vertices[0], vertices[1], vertices[2]);
+            if (std::abs(area) < 0.5f) {
+                continue;
+            }
+            if (area < 0.0f) {
+                std::swap(vertices[1], vertices[2]);
+            }
+
+            const std::size_t index = triangles.size();
+            triangles.push_back({
+                .vertices = vertices,
+                .uvs = {
+                    glm::vec2{uniform(random, 0.0f, 1.0f), uniform(random, 0.0f, 1.0f)},
+                    glm::vec2{uniform(random, 0.0f, 1.0f), uniform(random, 0.0f, 1.0f)},
+                    glm::vec2{uniform(random, 0.0f, 1.0f), uniform(random, 0.0f, 1.0f)}
+                },
+                .colors = {
+                    rasterizer::randomColor(3 * index), rasterizer::randomColor(3 * index + 1),
+                    rasterizer::randomColor(3 * index + 2)
+                },
+                .surface = surface
+            });
+        }
+
+        return triangles;
+    }
+
+    void benchmarkRasterization(const Options& options) {
+        auto random = createRandom();
+        const std::unique_ptr<rasterizer::Surface> surface = createSurface(256, random);
+        const rasterizer::Canvas canvas(CANVAS_WIDTH, CANVAS_HEIGHT);
+        rasterizer::FragmentCounters fragments;
+
+        for (const auto& distribution : triangleDistributions) {
+            for (const bool isTextured : {false, true}) {
+                const std::string suffix = std::format("/{}/{}", distribution.name,
+                                                       isTextured ? "texture" : "vertex-color");
+                const std::string topLeftName = "drawTriangleTopLeft" + suffix;
+                const std::string ddaName = "drawTriangleDDA" + suffix;
+                if (!options.isSelected(topLeftName) && !options.isSelected(ddaName)) {
+                    continue;
+                }
+
+                const auto triangles = createTriangles(distribution, surface.get());
+                // Every repetition draws the same triangles, which must not be rejected by the previous depth
+                const auto clear = [&] { canvas.clear(); };
+
+                if (options.isSelected(topLeftName)) {
+                    surface->lock();
+                    measure(options, topLeftName, triangles.size(), clear, [&] {
+                        for (const auto& triangle : triangles) {
+                            const auto& [v0, v1, v2] = triangle.vertices;
+                            const auto& [uv0, uv1, uv2] = triangle.uvs;
+                            if (isTextured) {
+                                CanvasKernels::drawTriangleTopLeft(canvas, v0, v1, v2,
+                                    CanvasKernels::TextureShader{v0, v1, v2, uv0, uv1, uv2, triangle.surface},
+                                    fragments);
+                            } else {
+                                CanvasKernels::drawTriangleTopLeft(canvas, v0, v1, v2,
+                                    CanvasKernels::VertexColorShader{triangle.colors}, fragments);
+                            }
+                        }
+                    });
+                    surface->unlock();
+                }
+
+                if (options.isSelected(ddaName)) {
+                    // Sorted vertically once, as drawTriangle does before calling DDA
+                    struct SortedTriangle {
+                        glm::vec4 v0, v1, v2;
+                        glm::ivec2 p0, p1, p2;
+                        glm::vec2 uv0, uv1, uv2;
+                        const rasterizer::Triangle* triangle;
+                    };
+                    std::vector<SortedTriangle> sorted;
+                    sorted.reserve(triangles.size());
+                    for (const auto& triangle : triangles) {
+                        auto& [v0, v1, v2, p0, p1, p2, uv0, uv1, uv2, source] = sorted.emplace_back(SortedTriangle{
+                            triangle.vertices[0], triangle.vertices[1], triangle.vertices[2],
+                            glm::ivec2{triangle.vertices[0]}, glm::ivec2{triangle.vertices[1]},
+                            glm::ivec2{triangle.vertices[2]},
+                            triangle.uvs[0], triangle.uvs[1], triangle.uvs[2], &triangle
+                        });
+                        CanvasKernels::sortAscendingVertically(v0, v1, v2, p0, p1, p2, uv0, uv1, uv2);
+                    }
+
+                    surface->lock();
+                    measure(options, ddaName, sorted.size(), clear, [&] {
+                        for (const auto& [v0, v1, v2, p0, p1, p2, uv0, uv1, uv2, triangle] : sorted) {
+                            if (isTextured) {
+                                CanvasKernels::drawTriangleDDA(canvas, v0, v1, v2, p0, p1, p2,
+                                    CanvasKernels::TextureShader{v0, v1, v2, uv0, uv1, uv2, triangle->surface},
+                                    fragments);
+                            } else {
+                                CanvasKernels::drawTriangleDDA(canvas, v0, v1, v2, p0, p1, p2,
+                                    CanvasKernels::VertexColorShader{triangle->colors}, fragments);
+                            }
+                        }
+                    });
+                    surface->unlock();
+                }
+            }
+        }
+        keep(fragments.passed);
+    }
+
+    constexpr std::size_t SAMPLES_AMOUNT = 1 << 20;
+
+    void benchmarkBarycentricWeights(const Options& options) {
+        static constexpr auto name = "barycentricWeights";
+        if (!options.isSelected(name)) {
+            return;
+        }
+
+        // Pixels within the bounding box of their triangle, as DDA feeds them
+        struct Sample {
+            glm::ivec2 a, b, c, p;
+        };
+        auto random = createRandom();
+        const auto coordinate = [&](const std::int32_t min, const std::int32_t max) {
+            return std::uniform_int_distribution<std::int32_t>(min, max)(random);
+        };
+        std::vector<Sample> samples(SAMPLES_AMOUNT);
+        for (auto& [a, b, c, p] : samples) {
+            do {
+                a = {coordinate(0, 63), coordinate(0, 63)};
+                b = {coordinate(0, 63), coordinate(0, 63)};
+                c = {coordinate(0, 63), coordinate(0, 63)};
+            } while (CanvasKernels::edgeCross(a, b, c) == 0.0f);
+            const auto min = glm::min(glm::min(a, b), c);
+            const auto max = glm::max(glm::max(a, b), c);
+            p = {coordinate(min.x, max.x), coordinate(min.y, max.y)};
+        }
+
+        measure(options, name, samples.size(), [&] {
+            glm::vec3 sum{0.0f};
+            for (const auto& [a, b, c, p] : samples) {
+                sum += CanvasKernels::barycentricWeights(a, b, c, p);
+            }
+            keep(sum.x + sum.y + sum.z);
+        });
+    }
+
+    void benchmarkInterpolateColor(const Options& options) {
+        static constexpr auto name = "interpolateColor";
+        if (!options.isSelected(name)) {
+            return;
+        }
+
+        struct Sample {
+            glm::vec3 weights;
+            std::array<rasterizer::color_t, 3> colors;
+        };
+        auto random = createRandom();
+        std::vector<Sample> samples(SAMPLES_AMOUNT);
+        for (auto& [weights, colors] : samples) {
+            weights = randomWeights(random);
+            colors = {
+                static_cast<rasterizer::color_t>(random()), static_cast<rasterizer::color_t>(random()),
+                static_cast<rasterizer::color_t>(random())
+            };
+        }
+
+        measure(options, name, samples.size(), [&] {
+            rasterizer::color_t checksum = 0;
+            for (const auto& [weights, colors] : samples) {
+                checksum ^= rasterizer::interpolateColor(weights, colors);
+            }
+            keep(checksum);
+        });
+    }
+
+    void benchmarkTextureColoring(const Options& options) {
+        // Fits in L1, L2, L3 and none of them
+        for (const std::uint32_t size : {64u, 256u, 1024u, 4096u}) {
+            const std::string name = std::format("textureColoring/{}x{}", size, size);
+            if (!options.isSelected(name)) {
+                continue;
+            }
+
+            struct Sample {
+                glm::vec4 v0, v1, v2;
+                glm::vec2 uv0, uv1, uv2;
+                glm::vec3 weights;
+                glm::float32_t wReciprocal;
+            };
+            auto random = createRandom();
+            const auto surface = createSurface(size, random);
+            std::vector<Sample> samples(SAMPLES_AMOUNT);
+            for (auto& [v0, v1, v2, uv0, uv1, uv2, weights, wReciprocal] : samples) {
+                for (auto* v : {&v0, &v1, &v2}) {
+                    *v = {0.0f, 0.0f, 0.5f, uniform(random, 1.0f, 50.0f)};
+                }
+                for (auto* uv : {&uv0, &uv1, &uv2}) {
+                    *uv = {uniform(random, 0.0f, 1.0f), uniform(random, 0.0f, 1.0f)};
+                }
+                weights = randomWeights(random);
+                wReciprocal = weights.x / v0.w + weights.y / v1.w + weights.z / v2.w;
+            }
+
+            surface->lock();
+            measure(options, name, samples.size(), [&] {
+                rasterizer::color_t checksum = 0;
+                for (const auto& [v0, v1, v2, uv0, uv1, uv2, weights, wReciprocal] : samples) {
+                    checksum ^= CanvasKernels::textureColoring(v0, v1, v2, uv0, uv1, uv2, weights, wReciprocal,
+                                                               surface.get());
+                }
+                keep(checksum);
+            });
+            surface->unlock();
+        }
+    }
+
+    void benchmarkClipPolygon(const Options& options) {
+        const rasterizer::Frustum frustum(CANVAS_WIDTH, CANVAS_HEIGHT, std::numbers::pi / 3.0f, 0.1f, 100.0f);
+        const float tanHorizontal = std::tan(frustum.fovHorizontal / 2.0f);
+        const float tanVertical = std::tan(frustum.fovVertical / 2.0f);
+
+        // View-space point from coordinates normalized to the side planes, |x|, |y| <= 1 is inside
+        const auto point = [&](const float x, const float y, const float z) {
+            return glm::vec3{x * z * tanHorizontal, y * z * tanVertical, z};
+        };
+
+        struct ClipCase {
+            const char* name;
+            // Range of each normalized coordinate, then of the depth, per vertex
+            std::array<float, 6> first, second, third;
+        };
+        static constexpr std::array<ClipCase, 6> clipCases{
+            ClipCase{"inside", {-0.8f, 0.8f, -0.8f, 0.8f, 1.0f, 90.0f},
+                     {-0.8f, 0.8f, -0.8f, 0.8f, 1.0f, 90.0f}, {-0.8f, 0.8f, -0.8f, 0.8f, 1.0f, 90.0f}},
+            // Rejected by the first plane
+            ClipCase{"outside", {1.2f, 2.0f, -0.8f, 0.8f, 1.0f, 90.0f},
+                     {1.2f, 2.0f, -0.8f, 0.8f, 1.0f, 90.0f}, {1.2f, 2.0f, -0.8f, 0.8f, 1.0f, 90.0f}},
+            ClipCase{"one-plane", {1.2f, 2.0f, -0.8f, 0.8f, 1.0f, 90.0f},
+                     {-0.8f, 0.8f, -0.8f, 0.8f, 1.0f, 90.0f}, {-0.8f, 0.8f, -0.8f, 0.8f, 1.0f, 90.0f}},
+            ClipCase{"corner", {1.2f, 2.0f, 1.2f, 2.0f, 1.0f, 90.0f},
+                     {-0.8f, 0.8f, -0.8f, 0.8f, 1.0f, 90.0f}, {-0.8f, 0.8f, -0.8f, 0.8f, 1.0f, 90.0f}},
+            // Vertex closer than the near plane
+            ClipCase{"near", {-0.8f, 0.8f, -0.8f, 0.8f, 0.01f, 0.05f},
+                     {-0.8f, 0.8f, -0.8f, 0.8f, 1.0f, 90.0f}, {-0.8f, 0.8f, -0.8f, 0.8f, 1.0f, 90.0f}},
+            // Covers the whole view, crossing every side plane
+            ClipCase{"spanning", {-4.0f, -2.0f, -4.0f, -2.0f, 5.0f, 10.0f},
+                     {2.0f, 4.0f, -4.0f, -2.0f, 5.0f, 10.0f}, {-1.0f, 1.0f, 2.0f, 4.0f, 5.0f, 10.0f}},
+        };
+
+        for (const auto& clipCase : clipCases) {
+            const std::string name = std::format("clipPolygon/{}", clipCase.name);
+            if (!options.isSelected(name)) {
+                continue;
+            }
+
+            auto random = createRandom();
+            const auto randomPoint = [&](const std::array<float, 6>& range) {
+                return point(uniform(random, range[0], range[1]), uniform(random, range[2], range[3]),
+                             uniform(random, range[4], range[5]));
+            };
+            std::vector<rasterizer::Polygon> polygons;
+            polygons.reserve(SAMPLES_AMOUNT / 8);
+            while (polygons.size() < SAMPLES_AMOUNT / 8) {
+                polygons.push_back(rasterizer::Polygon::fromTriangle(
+                    {randomPoint(clipCase.first), randomPoint(clipCase.second), randomPoint(clipCase.third)},
+                    {glm::vec2{0.0f, 0.0f}, glm::vec2{1.0f, 0.0f}, glm::vec2{0.0f, 1.0f}}));
+            }
+
+            measure(options, name, polygons.size(), [&] {
+                std::size_t trianglesAmount = 0;
+                for (const auto& polygon : polygons) {
+                    trianglesAmount += frustum.clipPolygon(polygon).trianglesAmount();
+                }
+                keep(trianglesAmount);
+            });
+        }
+    }
+
+    void benchmarkTransformations(const Options& options) {
+        static constexpr auto modelViewName = "computeModelViewTransformations";
+        static constexpr auto normalName = "computeNormalTransformations";
+        if (!options.isSelected(modelViewName) && !options.isSelected(normalName)) {
+            return;
+        }
+
+        auto random = createRandom();
+        std::vector<rasterizer::Instance> instances(4096);
+        for (auto& instance : instances) {
+            const float tau = 2.0f * std::numbers::pi_v<float>;
+            instance.rotation = {uniform(random, 0.0f, tau), uniform(random, 0.0f, tau), uniform(random, 0.0f, tau)};
+            instance.scale = glm::vec3{uniform(random, 0.5f, 2.0f)};
+            instance.translation = {
+                uniform(random, -50.0f, 50.0f), uniform(random, -50.0f, 50.0f), uniform(random, -50.0f, 50.0f)
+            };
+        }
+        rasterizer::Frustum frustum(CANVAS_WIDTH, CANVAS_HEIGHT, std::numbers::pi / 3.0f, 0.1f, 100.0f);
+        frustum.eye = {10.0f, 5.0f, -20.0f};
+        const glm::mat4 view = frustum.view(glm::vec3{0.0f}, glm::vec3{0.0f, 1.0f, 0.0f});
+
+        // Outputs are sized before timing, as Application reuses them across frames
+        std::vector<glm::mat4> modelViews;
+        std::vector<glm::mat3> normals;
+        rasterizer::computeModelViewTransformations(instances, view, modelViews);
+        rasterizer::computeNormalTransformations(modelViews, normals);
+
+        if (options.isSelected(modelViewName)) {
+            measure(options, modelViewName, instances.size(), [&] {
+                rasterizer::computeModelViewTransformations(instances, view, modelViews);
+                keep(modelViews.back()[3][2]);
+            });
+        }
+        if (options.isSelected(normalName)) {
+            measure(options, normalName, instances.size(), [&] {
+                rasterizer::computeNormalTransformations(modelViews, normals);
+                keep(normals.back()[2][2]);
+            });
+        }
+    }
+
+    void benchmarkParseObj(const Options& options) {
+        const auto directory = std::filesystem::temp_directory_path() / "rasterizer-microbench";
+
+        // Quads per side of a textured grid
+        // Timed with mesh building, simplification and meshlets included
+        for (const std::uint32_t quads : {32u, 128u}) {
+            const std::string name = std::format("parseObj/grid-{}x{}", quads, quads);
+            if (!options.isSelected(name)) {
+                continue;
+            }
+
+            std::filesystem::create_directories(directory);
+            const auto path = directory / std::format("grid_{}.obj", quads);
+            {
+                auto random = createRandom();
+                std::ofstream file(path, std::ios::trunc);
+                for (std::uint32_t y = 0; y <= quads; ++y) {
+                    for (std::uint32_t x = 0; x <= quads; ++x) {
+                        // Uneven heights, so that simplification has work to do
+                        file << std::format("v {:.6f} {:.6f} {:.6f}\n", static_cast<float>(x) / quads,
+                                            uniform(random, 0.0f, 0.05f), static_cast<float>(y) / quads);
+                        file << std::format("vt {:.6f} {:.6f}\n", static_cast<float>(x) / quads,
+                                            static_cast<float>(y) / quads);
+                    }
+                }
+                for (std::uint32_t y = 0; y < quads; ++y) {
+                    for (std::uint32_t x = 0; x < quads; ++x) {
+                        // OBJ indices start at 1
+                        const std::uint32_t corner = y * (quads + 1) + x + 1;
+                        const std::uint32_t below = corner + quads + 1;
+                        for (const auto& [first, second, third] : {
+                                 std::array{corner, below, corner + 1}, std::array{corner + 1, below, below + 1}
+                             }) {
+                            file << std::format("f {}/{} {}/{} {}/{}\n", first, first, second, second, third, third);
+                        }
+                    }
+                }
+                if (!file.good()) {
+                    throw std::runtime_error("Failed to write benchmark mesh: " + path.string());
+                }
+            }
+
+            measure(options, name, static_cast<std::size_t>(quads) * quads * 2, [&] {
+                keep(rasterizer::parseObj(path).verticesAmount());
+            });
+        }
+
+        std::error_code error;
+        std::filesystem::remove_all(directory, error);
+    }
+}
+
+int main(int argc, char* argv[]) try {
+    const Options options = parseOptions(argc, argv);
+
+    rasterizer::print("{} repetitions after {} warmup, nanoseconds per operation\n",
+                      options.repetitions, options.warmupRepetitions);
+    rasterizer::print("{:<42} {:>8} {:>12} {:>12} {:>12} {:>8}\n", "benchmark", "ops", "min", "median", "mean", "rsd");
+
+    benchmarkRasterization(options);
+    benchmarkBarycentricWeights(options);
+    benchmarkInterpolateColor(options);
+    benchmarkTextureColoring(options);
+    benchmarkClipPolygon(options);
+    benchmarkTransformations(options);
+    benchmarkParseObj(options);
+
+    return EXIT_SUCCESS;
+} catch (const std::exception& e) {
+    rasterizer::print(std::cerr, "Exiting due to: {}\n", e.what());
+    return EXIT_FAILURE;
+}